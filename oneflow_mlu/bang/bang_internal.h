@@ -26,6 +26,13 @@ struct AddressList {
   int64_t sizes[N];
 };
 
+// M pointers per tensor, e.g. model, model_diff and optimizer states of one parameter.
+template<int M, int N>
+struct TensorTupleAddressList {
+  void* address[M][N];
+  int64_t sizes[N];
+};
+
 template<typename T>
 __mlu_func__ T bang_static_cast(float scalar) {
   return static_cast<T>(scalar);
@@ -36,6 +43,26 @@ __mlu_func__ half bang_static_cast<half>(float scalar) {
   return __float2half_rd(scalar);
 }
 
+// Widens `size` elements in NRAM to float, half inputs go through temp.
+__mlu_func__ float* bang_as_float(float* input, float* temp, int32_t size) { return input; }
+
+__mlu_func__ float* bang_as_float(half* input, float* temp, int32_t size) {
+  __bang_half2float(temp, input, size);
+  return temp;
+}
+
+// Sum of `size` elements in NRAM.
+template<typename T>
+__mlu_func__ T bang_sum_nram(const T* src, int32_t size) {
+#if (__BANG_ARCH__ >= 520)
+  return __bang_sum(src, size);
+#else
+  T result = 0;
+  for (int32_t i = 0; i < size; ++i) { result += src[i]; }
+  return result;
+#endif
+}
+
 }  // namespace oneflow
 
 #endif  // ONEFLOW_CAMBRICON_BANG_BANG_INTERNAL_H_
@@ -20,6 +20,21 @@ limitations under the License.
 
 namespace oneflow {
 
+constexpr int32_t kBangMaxNumDims = 8;
+
+enum class BangBinaryOp : int32_t {
+  kAdd = 0,
+  kSub,
+  kMul,
+  kDiv,
+  kEqual,
+  kNotEqual,
+  kGreaterThan,
+  kGreaterEqual,
+  kLessThan,
+  kLessEqual,
+};
+
 void bang_memset_kernel(BangHandle& handle, void* ptr, int value, size_t num);
 
 // input is a 3D tensor with shape [batch, N, length]
@@ -85,6 +100,132 @@ void bang_adam_update_half_kernel(BangHandle& handle, int64_t n, T scale, float
                                   const float* bias_correction2_ptr, const void* model_diff,
                                   T* model, void* model_copy, T* m, T* v, T* max_v);
 
+template<typename T>
+void bang_adagrad_update_kernel(BangHandle& handle, int64_t n, T scale, float l1, float l2,
+                                float lr_decay, float epsilon, float weight_decay,
+                                float learning_rate, int32_t train_step,
+                                const float* learning_rate_ptr, const int64_t* train_step_ptr,
+                                const T* scale_by_ptr, const int64_t* skip_if, const T* model_diff,
+                                T* model, T* sum);
+
+template<typename T>
+void bang_adagrad_update_half_kernel(BangHandle& handle, int64_t n, T scale, float l1, float l2,
+                                     float lr_decay, float epsilon, float weight_decay,
+                                     float learning_rate, int32_t train_step,
+                                     const float* learning_rate_ptr, const int64_t* train_step_ptr,
+                                     const T* scale_by_ptr, const int64_t* skip_if,
+                                     const void* model_diff, T* model, T* sum);
+
+// mean_gradient is only read and written when centered is true.
+template<typename T>
+void bang_rmsprop_update_kernel(BangHandle& handle, int64_t n, T scale, float l1, float l2,
+                                bool centered, float epsilon, float decay_rate, float weight_decay,
+                                float learning_rate, const float* learning_rate_ptr,
+                                const T* scale_by_ptr, const int64_t* skip_if, const T* model_diff,
+                                T* model, T* mean_square, T* mean_gradient);
+
+template<typename T>
+void bang_rmsprop_update_half_kernel(BangHandle& handle, int64_t n, T scale, float l1, float l2,
+                                     bool centered, float epsilon, float decay_rate,
+                                     float weight_decay, float learning_rate,
+                                     const float* learning_rate_ptr, const T* scale_by_ptr,
+                                     const int64_t* skip_if, const void* model_diff, T* model,
+                                     T* mean_square, T* mean_gradient);
+
+template<typename T>
+void bang_ftrl_update_kernel(BangHandle& handle, int64_t n, T scale, float l1, float l2,
+                             float lr_power, float lambda1, float lambda2, float beta,
+                             float weight_decay, float learning_rate,
+                             const float* learning_rate_ptr, const T* scale_by_ptr,
+                             const int64_t* skip_if, const T* model_diff, T* model, T* accumulate,
+                             T* z);
+
+template<typename T>
+void bang_ftrl_update_half_kernel(BangHandle& handle, int64_t n, T scale, float l1, float l2,
+                                  float lr_power, float lambda1, float lambda2, float beta,
+                                  float weight_decay, float learning_rate,
+                                  const float* learning_rate_ptr, const T* scale_by_ptr,
+                                  const int64_t* skip_if, const void* model_diff, T* model,
+                                  T* accumulate, T* z);
+
+// Workspace of bang_lamb_update_kernel: the adam direction of all n elements followed by two
+// partial norms per task.
+template<typename T>
+size_t bang_lamb_update_workspace_size(const BangHandle& handle, int64_t n) {
+  return n * sizeof(T) + 2 * handle.nclusters * handle.ncores_per_cluster * sizeof(float);
+}
+
+// Runs in two launches, the first one updates m and v and reduces the partial norms of model and
+// of the adam direction per task, the second one applies the trust ratio.
+template<typename T>
+void bang_lamb_update_kernel(BangHandle& handle, int64_t n, T scale, float l1, float l2,
+                             float beta1, float beta2, float epsilon, float weight_decay,
+                             bool do_bias_correction, float learning_rate,
+                             float bias_correction1_val, float bias_correction2_val,
+                             const float* learning_rate_ptr, const T* scale_by_ptr,
+                             const int64_t* skip_if, const float* bias_correction1_ptr,
+                             const float* bias_correction2_ptr, const T* model_diff, T* model,
+                             T* m, T* v, void* workspace);
+
+template<typename T>
+void bang_lamb_update_half_kernel(BangHandle& handle, int64_t n, T scale, float l1, float l2,
+                                  float beta1, float beta2, float epsilon, float weight_decay,
+                                  bool do_bias_correction, float learning_rate,
+                                  float bias_correction1_val, float bias_correction2_val,
+                                  const float* learning_rate_ptr, const T* scale_by_ptr,
+                                  const int64_t* skip_if, const float* bias_correction1_ptr,
+                                  const float* bias_correction2_ptr, const void* model_diff,
+                                  T* model, T* m, T* v, void* workspace);
+
+// Multi-tensor optimizer updates over n parameters, parameter i has sizes[i] elements. Each launch
+// covers a batch of parameters and model_copy, the fp16 shadow of model, may be nullptr.
+template<typename T>
+void bang_multi_tensor_sgd_update_kernel(BangHandle& handle, int64_t n, const int64_t* sizes,
+                                         T scale, float l1, float l2, float weight_decay,
+                                         float learning_rate, const float* learning_rate_ptr,
+                                         const T* scale_by_ptr, const int64_t* skip_if,
+                                         const T** model_diff, T** model, void** model_copy);
+
+template<typename T>
+void bang_multi_tensor_sgd_update_half_kernel(BangHandle& handle, int64_t n, const int64_t* sizes,
+                                              T scale, float l1, float l2, float weight_decay,
+                                              float learning_rate, const float* learning_rate_ptr,
+                                              const T* scale_by_ptr, const int64_t* skip_if,
+                                              const void** model_diff, T** model,
+                                              void** model_copy);
+
+template<typename T>
+void bang_multi_tensor_momentum_update_kernel(
+    BangHandle& handle, int64_t n, const int64_t* sizes, T scale, float l1, float l2, float beta,
+    float dampening, bool nesterov, bool maximize, float weight_decay, float learning_rate,
+    const float* learning_rate_ptr, const T* scale_by_ptr, const int64_t* skip_if,
+    const T** model_diff, T** model, T** momentum, void** model_copy);
+
+template<typename T>
+void bang_multi_tensor_momentum_update_half_kernel(
+    BangHandle& handle, int64_t n, const int64_t* sizes, T scale, float l1, float l2, float beta,
+    float dampening, bool nesterov, bool maximize, float weight_decay, float learning_rate,
+    const float* learning_rate_ptr, const T* scale_by_ptr, const int64_t* skip_if,
+    const void** model_diff, T** model, T** momentum, void** model_copy);
+
+template<typename T>
+void bang_multi_tensor_adam_update_kernel(
+    BangHandle& handle, int64_t n, const int64_t* sizes, T scale, float l1, float l2, float beta1,
+    float beta2, float epsilon, float weight_decay, bool do_bias_correction, float learning_rate,
+    float bias_correction1_val, float bias_correction2_val, const float* learning_rate_ptr,
+    const T* scale_by_ptr, const int64_t* skip_if, const float* bias_correction1_ptr,
+    const float* bias_correction2_ptr, const T** model_diff, T** model, T** m, T** v,
+    void** model_copy);
+
+template<typename T>
+void bang_multi_tensor_adam_update_half_kernel(
+    BangHandle& handle, int64_t n, const int64_t* sizes, T scale, float l1, float l2, float beta1,
+    float beta2, float epsilon, float weight_decay, bool do_bias_correction, float learning_rate,
+    float bias_correction1_val, float bias_correction2_val, const float* learning_rate_ptr,
+    const T* scale_by_ptr, const int64_t* skip_if, const float* bias_correction1_ptr,
+    const float* bias_correction2_ptr, const void** model_diff, T** model, T** m, T** v,
+    void** model_copy);
+
 template<typename T>
 void bang_regularize_gradient_kernel(BangHandle& handle, int64_t n, const T* model,
                                      const T* model_diff, T* out, float l1, float l2);
@@ -92,10 +233,33 @@ void bang_regularize_gradient_kernel(BangHandle& handle, int64_t n, const T* mod
 void bang_regularize_gradient_half_kernel(BangHandle& handle, int64_t n, const void* model,
                                           const void* model_diff, void* out, float l1, float l2);
 
+// Partial norms and not finite counts per task followed by the clip coefficient.
+inline size_t bang_multi_tensor_norm_workspace_size(const BangHandle& handle) {
+  return handle.nclusters * handle.ncores_per_cluster * (sizeof(int64_t) + sizeof(float))
+         + sizeof(float);
+}
+
+// Reads every element once to get the p-norm of all inputs (sum of |x|^p unless take_root) and
+// the number of inf and nan elements. norm and not_finite may be null. When clip is set the
+// coefficient max_norm / (norm + 1e-6) is kept in workspace for bang_multi_tensor_clip_kernel.
 template<typename T>
-void bang_multi_reduce_sum_pow_abs_kernel(BangHandle& handle, int64_t n, const T** inputs,
-                                          const int64_t* sizes, T* output, float p, void* workspace,
-                                          int64_t workspace_size);
+void bang_multi_tensor_norm_kernel(BangHandle& handle, int64_t n, const T** inputs,
+                                   const int64_t* sizes, float p, bool take_root, T* norm,
+                                   int64_t* not_finite, bool clip, float max_norm,
+                                   void* workspace);
+
+void bang_multi_tensor_norm_half_kernel(BangHandle& handle, int64_t n, const void** inputs,
+                                        const int64_t* sizes, float p, bool take_root, void* norm,
+                                        int64_t* not_finite, bool clip, float max_norm,
+                                        void* workspace);
+
+// Scales the inputs in place by the clip coefficient left in workspace if it is below 1.
+template<typename T>
+void bang_multi_tensor_clip_kernel(BangHandle& handle, int64_t n, T** inputs, const int64_t* sizes,
+                                   const void* workspace);
+
+void bang_multi_tensor_clip_half_kernel(BangHandle& handle, int64_t n, void** inputs,
+                                        const int64_t* sizes, const void* workspace);
 
 template<typename T>
 void bang_multi_count_not_finite_kernel(BangHandle& handle, int64_t n, const T** inputs,
@@ -128,6 +292,101 @@ void bang_fast_gelu_grad_half_kernel(BangHandle& handle, int64_t n, const void*
 template<typename T>
 void bang_sqrt_square_sum_kernel(BangHandle& handle, int64_t n, const T* in, T* out);
 
+// src0 and src1 are broadcast to dst_dims by their strides (0 for broadcast axes),
+// dst is a contiguous tensor with shape dst_dims and ndim <= kBangMaxNumDims
+template<typename T, typename D>
+void bang_broadcast_binary_kernel(BangHandle& handle, BangBinaryOp op, int64_t ndim,
+                                  const int64_t* dst_dims, const T* src0,
+                                  const int64_t* src0_strides, const T* src1,
+                                  const int64_t* src1_strides, D* dst);
+
+// Copies an `extent` shaped region between two strided buffers in one pass, strides are in
+// elements of elem_size bytes. Supported when ndim <= kBangMaxNumDims and no stride is negative
+// or spans more than 2^31 - 1 bytes.
+bool bang_strided_copy_supported(int64_t elem_size, int64_t ndim, const int64_t* src_strides,
+                                 const int64_t* dst_strides);
+
+void bang_strided_copy_kernel(BangHandle& handle, int64_t elem_size, int64_t ndim,
+                              const int64_t* extent, const void* src, const int64_t* src_strides,
+                              void* dst, const int64_t* dst_strides);
+
+// Splits the (rows, in_cols) view of in along the columns into num_outputs contiguous
+// (rows, out_cols[i]) outputs, reading in once. Empty outputs are skipped.
+void bang_split_kernel(BangHandle& handle, int64_t elem_size, int64_t rows, int64_t in_cols,
+                       int64_t num_outputs, void* const* outputs, const int64_t* out_cols,
+                       const void* in);
+
+// out[i] = start + i * delta computed in T, for int64_t, uint64_t and double.
+template<typename T>
+void bang_arange_kernel(BangHandle& handle, int64_t n, T start, T delta, T* out);
+
+// NLL loss of (n, c) log-probabilities with int32 or int64 targets. weight may be null for unit
+// class weights, ignored samples get zero loss, out_weight and gradient.
+template<typename T, typename K>
+void bang_nll_forward_kernel(BangHandle& handle, int64_t n, int64_t c, const T* input,
+                             const K* target, const T* weight, K ignore_index, T* out,
+                             T* out_weight);
+
+template<typename K>
+void bang_nll_forward_half_kernel(BangHandle& handle, int64_t n, int64_t c, const void* input,
+                                  const K* target, const void* weight, K ignore_index, void* out,
+                                  void* out_weight);
+
+template<typename T, typename K>
+void bang_nll_backward_kernel(BangHandle& handle, int64_t n, int64_t c, const T* out_grad,
+                              const K* target, const T* weight, K ignore_index, T* in_grad);
+
+template<typename K>
+void bang_nll_backward_half_kernel(BangHandle& handle, int64_t n, int64_t c, const void* out_grad,
+                                   const K* target, const void* weight, K ignore_index,
+                                   void* in_grad);
+
+// dx = dy where min_value <= x <= max_value and 0 elsewhere, pass +-inf for a missing bound.
+template<typename T>
+void bang_clip_by_scalar_grad_kernel(BangHandle& handle, int64_t n, float min_value,
+                                     float max_value, const T* x, const T* dy, T* dx);
+
+void bang_clip_by_scalar_grad_half_kernel(BangHandle& handle, int64_t n, float min_value,
+                                          float max_value, const void* x, const void* dy,
+                                          void* dx);
+
+// Philox4x32-10 streams keyed by seed and offset, element i of the output only depends on
+// (seed, offset, i). Callers take a fresh offset from the generator for every launch.
+template<typename T>
+void bang_philox_uniform_kernel(BangHandle& handle, int64_t n, uint64_t seed, uint64_t offset,
+                                float from, float to, T* out);
+
+void bang_philox_uniform_half_kernel(BangHandle& handle, int64_t n, uint64_t seed,
+                                     uint64_t offset, float from, float to, void* out);
+
+template<typename T>
+void bang_philox_normal_kernel(BangHandle& handle, int64_t n, uint64_t seed, uint64_t offset,
+                               float mean, float std, T* out);
+
+void bang_philox_normal_half_kernel(BangHandle& handle, int64_t n, uint64_t seed, uint64_t offset,
+                                    float mean, float std, void* out);
+
+// mask = uniform[0, 1) < 1 - rate, written straight from NRAM without a float buffer in between.
+void bang_philox_random_mask_kernel(BangHandle& handle, int64_t n, uint64_t seed, uint64_t offset,
+                                    float rate, bool* mask);
+
+// out = in * mask / (1 - rate), mask holds the kept elements.
+template<typename T>
+void bang_philox_dropout_kernel(BangHandle& handle, int64_t n, uint64_t seed, uint64_t offset,
+                                float rate, const T* in, bool* mask, T* out);
+
+void bang_philox_dropout_half_kernel(BangHandle& handle, int64_t n, uint64_t seed,
+                                     uint64_t offset, float rate, const void* in, bool* mask,
+                                     void* out);
+
+// Casts between the int16/int32 window local indices of the CNNL pooling functions and the int64
+// index tensors of the pooling ops in a single pass. Indices must be non-negative.
+template<typename S>
+void bang_widen_index_kernel(BangHandle& handle, int64_t n, const S* in, int64_t* out);
+
+template<typename S>
+void bang_narrow_index_kernel(BangHandle& handle, int64_t n, const int64_t* in, S* out);
+
 }  // namespace oneflow
 
 #endif  // ONEFLOW_CAMBRICON_BANG_BANG_KERNELS_H_
@@ -0,0 +1,72 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CAMBRICON_BANG_BANG_PHILOX_H_
+#define ONEFLOW_CAMBRICON_BANG_BANG_PHILOX_H_
+
+#include <stdint.h>
+
+namespace oneflow {
+
+// Philox4x32-10 counter based generator (Salmon et al., "Parallel Random Numbers: As Easy as
+// 1, 2, 3"). Block `index` of the stream (seed, offset) is a pure function of these three values,
+// so element i of a generated tensor does not depend on how the launch is split into tasks and
+// tiles. Every block yields 4 random words for elements 4 * index .. 4 * index + 3.
+struct BangPhilox {
+  uint32_t key[2];
+  uint32_t offset[2];
+
+  __mlu_func__ void init(uint64_t seed, uint64_t philox_offset) {
+    key[0] = static_cast<uint32_t>(seed);
+    key[1] = static_cast<uint32_t>(seed >> 32);
+    offset[0] = static_cast<uint32_t>(philox_offset);
+    offset[1] = static_cast<uint32_t>(philox_offset >> 32);
+  }
+
+  __mlu_func__ void block(uint64_t index, uint32_t out[4]) const {
+    uint32_t c[4] = {static_cast<uint32_t>(index), static_cast<uint32_t>(index >> 32), offset[0],
+                     offset[1]};
+    uint32_t k0 = key[0];
+    uint32_t k1 = key[1];
+    for (int round = 0; round < 10; ++round) {
+      uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * c[0];
+      uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * c[2];
+      uint32_t hi0 = static_cast<uint32_t>(p0 >> 32);
+      uint32_t hi1 = static_cast<uint32_t>(p1 >> 32);
+      c[0] = hi1 ^ c[1] ^ k0;
+      c[1] = static_cast<uint32_t>(p1);
+      c[2] = hi0 ^ c[3] ^ k1;
+      c[3] = static_cast<uint32_t>(p0);
+      k0 += 0x9E3779B9u;
+      k1 += 0xBB67AE85u;
+    }
+    for (int i = 0; i < 4; ++i) { out[i] = c[i]; }
+  }
+
+  // Uniform floats in [0, 1) with 24 random bits for elements first .. first + count - 1 of the
+  // stream. first must be a multiple of 4 and count is rounded up to whole blocks, so dst needs
+  // room for that many values.
+  __mlu_func__ void fill_uniform(float* dst, int64_t first, int32_t count) const {
+    uint32_t words[4];
+    for (int32_t i = 0; i < count; i += 4) {
+      block((first + i) / 4, words);
+      for (int32_t j = 0; j < 4; ++j) { dst[i + j] = (words[j] >> 8) * 5.9604644775390625e-08f; }
+    }
+  }
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CAMBRICON_BANG_BANG_PHILOX_H_
@@ -0,0 +1,168 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CAMBRICON_BANG_BANG_PIPELINE_H_
+#define ONEFLOW_CAMBRICON_BANG_BANG_PIPELINE_H_
+
+#include <stdint.h>
+
+namespace oneflow {
+
+// NRAM capacity of one core for the architecture being compiled, in bytes.
+#if defined(__MLU_NRAM_SIZE__)
+#define BANG_NRAM_SIZE (__MLU_NRAM_SIZE__ * 1024)
+#else
+#define BANG_NRAM_SIZE (512 * 1024)
+#endif
+
+// Part of NRAM a pipelined kernel may carve into tiles, the rest is left for the stack and the
+// fixed size __nram__ arrays of other kernels.
+static constexpr int32_t kBangPipelineNramBytes = BANG_NRAM_SIZE - 128 * 1024;
+
+// Tiles are a multiple of this many elements so every buffer carved from NRAM stays 128-byte
+// aligned for the vector instructions, even for 2-byte types.
+static constexpr int32_t kBangPipelineTileAlign = 64;
+
+// Hands out consecutive buffers of a raw __nram__ array.
+struct BangNramArena {
+  int8_t* ptr;
+
+  template<typename T>
+  __mlu_func__ T* alloc(int32_t count) {
+    T* buffer = reinterpret_cast<T*>(ptr);
+    ptr += count * sizeof(T);
+    return buffer;
+  }
+};
+
+// Largest tile whose buffers, bytes_per_elem bytes per element in total over both stages and the
+// scratch buffers, fit into kBangPipelineNramBytes.
+__mlu_func__ int32_t bang_pipeline_tile_size(int32_t bytes_per_elem) {
+  int32_t tile = kBangPipelineNramBytes / bytes_per_elem;
+  return tile / kBangPipelineTileAlign * kBangPipelineTileAlign;
+}
+
+// Processes `length` elements in tiles of `tile` elements with a two stage ping-pong pipeline:
+// while tile i is computed on one stage, tile i + 1 is loaded into the other stage and the
+// results of tile i - 1 are stored from it. Op provides
+//   load(stage, offset, count): async copies of the inputs of a tile into the stage,
+//   compute(stage, count): reads the inputs of the stage and writes its outputs,
+//   store(stage, offset, count): async copies of the outputs of the stage back to GDRAM.
+// Input and output buffers of a stage must not alias since the load of tile i + 2 is in flight
+// together with the store of tile i.
+template<typename Op>
+__mlu_func__ void bang_pipeline_run(Op& op, int64_t length, int32_t tile) {
+  int64_t repeat = (length + tile - 1) / tile;
+  for (int64_t i = 0; i < repeat + 2; ++i) {
+    if (i >= 2) {
+      int64_t offset = (i - 2) * tile;
+      int32_t count = (length - offset) < tile ? (length - offset) : tile;
+      op.store(i & 1, offset, count);
+    }
+    if (i < repeat) {
+      int64_t offset = i * tile;
+      int32_t count = (length - offset) < tile ? (length - offset) : tile;
+      op.load(i & 1, offset, count);
+    }
+    if (i >= 1 && i <= repeat) {
+      int64_t offset = (i - 1) * tile;
+      int32_t count = (length - offset) < tile ? (length - offset) : tile;
+      op.compute((i - 1) & 1, count);
+    }
+    __sync_io();
+    __sync_compute();
+  }
+}
+
+// A chunk of at most `tile` elements of one tensor in a list of tensors.
+struct BangChunk {
+  int32_t tensor;
+  int64_t offset;
+  int32_t count;
+};
+
+// Walks the chunks this task owns in a list of tensors. Chunks are dealt round-robin over all
+// tasks and the dealing continues across tensor boundaries, so a list of many small tensors still
+// keeps every core busy.
+struct BangTensorChunkIterator {
+  const int64_t* sizes;
+  int32_t num_tensors;
+  int32_t tile;
+  int32_t tensor;
+  int64_t chunk_base;
+  int64_t chunk;
+
+  __mlu_func__ void reset(const int64_t* tensor_sizes, int32_t num, int32_t tile_size) {
+    sizes = tensor_sizes;
+    num_tensors = num;
+    tile = tile_size;
+    tensor = 0;
+    chunk_base = 0;
+    chunk = taskId;
+  }
+
+  __mlu_func__ bool next(BangChunk* result) {
+    while (tensor < num_tensors) {
+      int64_t size = sizes[tensor];
+      int64_t num_chunks = (size + tile - 1) / tile;
+      if (chunk < num_chunks) {
+        result->tensor = tensor;
+        result->offset = chunk * tile;
+        result->count = (size - result->offset) < tile ? (size - result->offset) : tile;
+        chunk += taskDim;
+        return true;
+      }
+      chunk_base += num_chunks;
+      ++tensor;
+      chunk = ((taskId - chunk_base) % taskDim + taskDim) % taskDim;
+    }
+    return false;
+  }
+};
+
+// Same pipeline as bang_pipeline_run over the chunks an iterator yields, Op provides
+// load(stage, chunk), compute(stage, chunk) and store(stage, chunk). store may be empty for
+// reductions.
+template<typename Op, typename Iterator>
+__mlu_func__ void bang_pipeline_run_chunks(Op& op, Iterator& iterator) {
+  BangChunk chunks[2];
+  bool to_compute[2] = {false, false};
+  bool to_store[2] = {false, false};
+  bool has_next = true;
+  for (int32_t i = 0; has_next || to_compute[0] || to_compute[1] || to_store[0] || to_store[1];
+       ++i) {
+    int32_t s = i & 1;
+    if (to_store[s]) {
+      op.store(s, chunks[s]);
+      to_store[s] = false;
+    }
+    if (has_next) { has_next = iterator.next(&chunks[s]); }
+    if (has_next) {
+      op.load(s, chunks[s]);
+      to_compute[s] = true;
+    }
+    if (to_compute[s ^ 1]) {
+      op.compute(s ^ 1, chunks[s ^ 1]);
+      to_compute[s ^ 1] = false;
+      to_store[s ^ 1] = true;
+    }
+    __sync_io();
+    __sync_compute();
+  }
+}
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CAMBRICON_BANG_BANG_PIPELINE_H_
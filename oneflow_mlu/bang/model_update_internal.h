@@ -0,0 +1,55 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CAMBRICON_BANG_MODEL_UPDATE_INTERNAL_H_
+#define ONEFLOW_CAMBRICON_BANG_MODEL_UPDATE_INTERNAL_H_
+
+#include <stdint.h>
+
+namespace oneflow {
+
+// model_diff = model_diff * scale + l1 * sign(model) + l2 * model
+template<typename T>
+__mlu_func__ void regularize_model_diff(T* model_diff, const T* model, T scale, float l1, float l2,
+                                        T* temp0, T* temp1, int32_t size) {
+  __bang_mul_scalar(model_diff, model_diff, scale, size);
+  __bang_ge_scalar(temp0, model, 0, size);
+  __bang_le_scalar(temp1, model, 0, size);
+  __bang_sub(temp0, temp0, temp1, size);
+  __bang_mul_scalar(temp0, temp0, l1, size);
+  __bang_mul_scalar(temp1, model, l2, size);
+  __bang_fusion(FUSION_FAA, model_diff, model_diff, temp0, temp1, size, size);
+}
+
+// Returns the float model_diff of a tile loaded into NRAM, half gradients are converted into
+// `temp`.
+__mlu_func__ float* model_diff_as_float(float* model_diff, float* temp, int32_t size) {
+  return model_diff;
+}
+
+__mlu_func__ float* model_diff_as_float(half* model_diff, float* temp, int32_t size) {
+  __bang_half2float(temp, model_diff, size);
+  return temp;
+}
+
+// NRAM bytes per element of the float scratch buffer model_diff_as_float needs for G.
+template<typename G>
+__mlu_func__ int32_t model_diff_temp_bytes() {
+  return sizeof(G) == sizeof(float) ? 0 : sizeof(float);
+}
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CAMBRICON_BANG_MODEL_UPDATE_INTERNAL_H_
@@ -0,0 +1,89 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CAMBRICON_BENCHMARK_BENCHMARK_H_
+#define ONEFLOW_CAMBRICON_BENCHMARK_BENCHMARK_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "oneflow/core/common/data_type.h"
+#include "oneflow_mlu/ep/mlu_device.h"
+#include "oneflow_mlu/ep/mlu_stream.h"
+
+namespace oneflow {
+namespace mlu {
+namespace benchmark {
+
+// Owns the device buffers a benchmark case allocates during setup.
+class BenchmarkContext {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(BenchmarkContext);
+  BenchmarkContext(ep::MluDevice* device, ep::MluStream* stream)
+      : device_(device), stream_(stream) {}
+  ~BenchmarkContext();
+
+  ep::MluDevice* device() const { return device_; }
+  ep::MluStream* stream() const { return stream_; }
+
+  // Device buffer of `count` elements, filled with a small positive constant so math ops stay
+  // finite.
+  void* Alloc(DataType data_type, int64_t count);
+
+ private:
+  ep::MluDevice* device_;
+  ep::MluStream* stream_;
+  std::vector<void*> buffers_;
+};
+
+// A benchmark case allocates its inputs and returns the closure that enqueues one launch. Only the
+// closure is timed.
+using BenchmarkSetup = std::function<std::function<void()>(BenchmarkContext* ctx)>;
+
+struct BenchmarkCase {
+  std::string name;
+  BenchmarkSetup setup;
+  // bytes one launch reads from and writes to device memory, 0 if the case does not report
+  // bandwidth
+  int64_t bytes = 0;
+};
+
+std::vector<BenchmarkCase>* MutBenchmarkCases();
+
+inline void RegisterBenchmark(const std::string& name, BenchmarkSetup setup, int64_t bytes = 0) {
+  MutBenchmarkCases()->push_back(BenchmarkCase{name, std::move(setup), bytes});
+}
+
+struct BenchmarkRegisterer {
+  explicit BenchmarkRegisterer(const std::function<void()>& register_fn) { register_fn(); }
+};
+
+std::string ShapeToString(const std::vector<int64_t>& shape);
+
+}  // namespace benchmark
+}  // namespace mlu
+}  // namespace oneflow
+
+#define ONEFLOW_MLU_BENCHMARK_CAT_(a, b) a##b
+#define ONEFLOW_MLU_BENCHMARK_CAT(a, b) ONEFLOW_MLU_BENCHMARK_CAT_(a, b)
+
+// Runs `register_fn` during static initialization, it calls RegisterBenchmark once per
+// shape/dtype combination.
+#define REGISTER_MLU_BENCHMARKS(register_fn)            \
+  static ::oneflow::mlu::benchmark::BenchmarkRegisterer \
+      ONEFLOW_MLU_BENCHMARK_CAT(g_mlu_benchmark_registerer_, __COUNTER__)(register_fn)
+
+#endif  // ONEFLOW_CAMBRICON_BENCHMARK_BENCHMARK_H_
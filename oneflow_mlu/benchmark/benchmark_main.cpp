@@ -0,0 +1,225 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <sstream>
+
+#include "oneflow/core/common/scalar.h"
+#include "oneflow/core/ep/include/device_manager_registry.h"
+#include "oneflow/core/ep/include/primitive/fill.h"
+#include "oneflow_mlu/benchmark/benchmark.h"
+#include "oneflow_mlu/common/mlu_util.h"
+#include "oneflow_mlu/ep/mlu_event.h"
+
+namespace oneflow {
+namespace mlu {
+namespace benchmark {
+
+BenchmarkContext::~BenchmarkContext() {
+  CHECK_JUST(stream_->Sync());
+  for (void* ptr : buffers_) { device_->Free(ep::AllocationOptions{}, ptr); }
+}
+
+void* BenchmarkContext::Alloc(DataType data_type, int64_t count) {
+  const size_t size = std::max<int64_t>(count, 1) * GetSizeOfDataType(data_type);
+  void* ptr = nullptr;
+  CHECK_JUST(device_->Alloc(ep::AllocationOptions{}, &ptr, size));
+  buffers_.push_back(ptr);
+  auto fill = ep::primitive::NewPrimitive<ep::primitive::FillFactory>(DeviceType::kMLU, data_type);
+  if (fill) {
+    fill->Launch(stream_, ptr, Scalar(1), count);
+  } else {
+    OF_MLU_CHECK(cnrtMemsetAsync(ptr, 0, size, stream_->mlu_stream()));
+  }
+  return ptr;
+}
+
+std::vector<BenchmarkCase>* MutBenchmarkCases() {
+  static std::vector<BenchmarkCase> cases;
+  return &cases;
+}
+
+std::string ShapeToString(const std::vector<int64_t>& shape) {
+  std::ostringstream ss;
+  for (size_t i = 0; i < shape.size(); ++i) { ss << (i == 0 ? "" : "x") << shape[i]; }
+  return ss.str();
+}
+
+namespace {
+
+struct BenchmarkOptions {
+  int64_t device_index = 0;
+  int64_t warmup = 10;
+  int64_t iterations = 100;
+  std::string filter = ".*";
+  std::string out;
+};
+
+struct BenchmarkResult {
+  std::string name;
+  int64_t iterations = 0;
+  // wall time spent enqueuing one launch on the host
+  double host_time_us = 0;
+  // queue time between notifiers placed around the timed launches, per launch
+  double device_time_us = 0;
+  // device memory bandwidth in GB/s derived from device_time_us, 0 if the case has no byte count
+  double bandwidth_gbps = 0;
+};
+
+bool ParseFlag(const std::string& arg, const std::string& flag, std::string* value) {
+  const std::string prefix = "--" + flag + "=";
+  if (arg.compare(0, prefix.size(), prefix) != 0) { return false; }
+  *value = arg.substr(prefix.size());
+  return true;
+}
+
+BenchmarkOptions ParseOptions(int argc, char** argv) {
+  BenchmarkOptions options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    std::string value;
+    if (ParseFlag(arg, "filter", &value)) {
+      options.filter = value;
+    } else if (ParseFlag(arg, "warmup", &value)) {
+      options.warmup = std::stoll(value);
+    } else if (ParseFlag(arg, "iterations", &value)) {
+      options.iterations = std::stoll(value);
+    } else if (ParseFlag(arg, "device", &value)) {
+      options.device_index = std::stoll(value);
+    } else if (ParseFlag(arg, "out", &value)) {
+      options.out = value;
+    } else {
+      std::cerr << "usage: " << argv[0]
+                << " [--filter=<regex>] [--warmup=<n>] [--iterations=<n>] [--device=<index>]"
+                   " [--out=<json file>]"
+                << std::endl;
+      std::exit(1);
+    }
+  }
+  CHECK_GT(options.iterations, 0);
+  return options;
+}
+
+bool RunCase(const BenchmarkCase& benchmark_case, const BenchmarkOptions& options,
+             ep::MluDevice* device, ep::MluStream* stream, BenchmarkResult* result) {
+  BenchmarkContext ctx(device, stream);
+  std::function<void()> launch = benchmark_case.setup(&ctx);
+  // setup returns an empty closure when the primitive is not available for this case
+  if (!launch) { return false; }
+  for (int64_t i = 0; i < options.warmup; ++i) { launch(); }
+  CHECK_JUST(stream->Sync());
+
+  ep::Event* events[2];
+  device->CreateEvents(events, 2);
+  stream->RecordEvent(events[0]);
+  const auto start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < options.iterations; ++i) { launch(); }
+  const auto end = std::chrono::steady_clock::now();
+  stream->RecordEvent(events[1]);
+  CHECK_JUST(stream->Sync());
+  float device_time_us = 0;
+  OF_MLU_CHECK(cnrtNotifierDuration(static_cast<ep::MluEvent*>(events[0])->mlu_event(),
+                                    static_cast<ep::MluEvent*>(events[1])->mlu_event(),
+                                    &device_time_us));
+  device->DestroyEvents(events, 2);
+
+  result->name = benchmark_case.name;
+  result->iterations = options.iterations;
+  result->host_time_us =
+      std::chrono::duration<double, std::micro>(end - start).count() / options.iterations;
+  result->device_time_us = device_time_us / options.iterations;
+  if (benchmark_case.bytes > 0 && result->device_time_us > 0) {
+    result->bandwidth_gbps = benchmark_case.bytes / result->device_time_us / 1e3;
+  }
+  return true;
+}
+
+void WriteJson(std::ostream& os, const BenchmarkOptions& options, const ep::MluDevice* device,
+               const std::vector<BenchmarkResult>& results) {
+  os << "{\n";
+  os << "  \"context\": {\n";
+  os << "    \"device\": \"mlu:" << options.device_index << "\",\n";
+  os << "    \"nclusters\": " << device->nclusters() << ",\n";
+  os << "    \"ncores_per_cluster\": " << device->ncores_per_cluster() << ",\n";
+  os << "    \"warmup\": " << options.warmup << "\n";
+  os << "  },\n";
+  os << "  \"benchmarks\": [";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const BenchmarkResult& result = results[i];
+    os << (i == 0 ? "\n" : ",\n");
+    os << "    {\"name\": \"" << result.name << "\", \"iterations\": " << result.iterations
+       << ", \"host_time\": " << result.host_time_us
+       << ", \"device_time\": " << result.device_time_us << ", \"time_unit\": \"us\"";
+    if (result.bandwidth_gbps > 0) { os << ", \"bandwidth_gbps\": " << result.bandwidth_gbps; }
+    os << "}";
+  }
+  os << "\n  ]\n";
+  os << "}\n";
+}
+
+int Main(int argc, char** argv) {
+  const BenchmarkOptions options = ParseOptions(argc, argv);
+  ep::DeviceManagerRegistry registry;
+  std::shared_ptr<ep::Device> ep_device =
+      registry.GetDevice(DeviceType::kMLU, options.device_index);
+  CHECK(ep_device) << "no MLU device " << options.device_index;
+  auto* device = static_cast<ep::MluDevice*>(ep_device.get());
+  device->SetAsActiveDevice();
+  ep::Stream* ep_stream = device->CreateStream();
+  auto* stream = ep_stream->As<ep::MluStream>();
+
+  const std::regex filter(options.filter);
+  std::vector<BenchmarkResult> results;
+  std::printf("%-64s %12s %14s %14s %10s\n", "benchmark", "iterations", "host (us)", "device (us)",
+              "GB/s");
+  for (const BenchmarkCase& benchmark_case : *MutBenchmarkCases()) {
+    if (!std::regex_search(benchmark_case.name, filter)) { continue; }
+    BenchmarkResult result;
+    if (!RunCase(benchmark_case, options, device, stream, &result)) {
+      std::printf("%-64s %12s\n", benchmark_case.name.c_str(), "skipped");
+      continue;
+    }
+    std::printf("%-64s %12lld %14.3f %14.3f", result.name.c_str(),
+                static_cast<long long>(result.iterations), result.host_time_us,
+                result.device_time_us);
+    if (result.bandwidth_gbps > 0) {
+      std::printf(" %10.2f\n", result.bandwidth_gbps);
+    } else {
+      std::printf(" %10s\n", "-");
+    }
+    results.push_back(result);
+  }
+
+  if (!options.out.empty()) {
+    std::ofstream ofs(options.out);
+    CHECK(ofs.is_open()) << "can not open " << options.out;
+    WriteJson(ofs, options, device, results);
+  }
+  device->DestroyStream(ep_stream);
+  return 0;
+}
+
+}  // namespace
+
+}  // namespace benchmark
+}  // namespace mlu
+}  // namespace oneflow
+
+int main(int argc, char** argv) { return oneflow::mlu::benchmark::Main(argc, argv); }
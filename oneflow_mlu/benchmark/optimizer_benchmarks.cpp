@@ -0,0 +1,129 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/ep/include/primitive/memcpy.h"
+#include "oneflow_mlu/bang/bang_kernels.h"
+#include "oneflow_mlu/benchmark/benchmark.h"
+
+namespace oneflow {
+namespace mlu {
+namespace benchmark {
+
+namespace {
+
+// Optimizer updates are bandwidth bound, so the cases report GB/s next to a device to device
+// memcpy of the same element count as the reference for peak bandwidth.
+const std::vector<int64_t> kModelSizes = {1 << 16, 1 << 20, 1 << 24};
+
+BangHandle GetBangHandle(BenchmarkContext* ctx) {
+  return BangHandle(ctx->stream()->mlu_stream(), ctx->device()->nclusters(),
+                    ctx->device()->ncores_per_cluster());
+}
+
+void RegisterMemcpyReferenceBenchmarks() {
+  for (int64_t count : kModelSizes) {
+    const int64_t size = count * sizeof(float);
+    RegisterBenchmark(
+        "model_update/memcpy/" + std::to_string(count),
+        [=](BenchmarkContext* ctx) -> std::function<void()> {
+          std::shared_ptr<ep::primitive::Memcpy> memcpy =
+              ep::primitive::NewPrimitive<ep::primitive::MemcpyFactory>(
+                  DeviceType::kMLU, ep::primitive::MemcpyKind::kDtoD);
+          if (!memcpy) { return nullptr; }
+          void* src = ctx->Alloc(DataType::kFloat, count);
+          void* dst = ctx->Alloc(DataType::kFloat, count);
+          return [=]() { memcpy->Launch(ctx->stream(), dst, src, size); };
+        },
+        2 * size);
+  }
+}
+
+void RegisterMomentumUpdateBenchmarks() {
+  for (bool half_diff : {false, true}) {
+    for (int64_t count : kModelSizes) {
+      const int64_t diff_size = half_diff ? sizeof(float16) : sizeof(float);
+      // reads model, model_diff and momentum, writes model and momentum
+      const int64_t bytes = count * (4 * sizeof(float) + diff_size);
+      RegisterBenchmark(
+          std::string("model_update/momentum/") + (half_diff ? "half_diff/" : "float_diff/")
+              + std::to_string(count),
+          [=](BenchmarkContext* ctx) -> std::function<void()> {
+            float* model = static_cast<float*>(ctx->Alloc(DataType::kFloat, count));
+            float* momentum = static_cast<float*>(ctx->Alloc(DataType::kFloat, count));
+            void* model_diff =
+                ctx->Alloc(half_diff ? DataType::kFloat16 : DataType::kFloat, count);
+            return [=]() {
+              BangHandle handle = GetBangHandle(ctx);
+              if (half_diff) {
+                bang_momentum_update_half_kernel<float>(
+                    handle, count, 1.f, 0.f, 0.f, 0.9f, 0.f, false, false, 0.f, 1e-3f, 1.f,
+                    nullptr, nullptr, nullptr, model_diff, model, momentum);
+              } else {
+                bang_momentum_update_kernel<float>(
+                    handle, count, 1.f, 0.f, 0.f, 0.9f, 0.f, false, false, 0.f, 1e-3f, 1.f,
+                    nullptr, nullptr, nullptr, static_cast<const float*>(model_diff), model,
+                    momentum);
+              }
+            };
+          },
+          bytes);
+    }
+  }
+}
+
+void RegisterAdamUpdateBenchmarks() {
+  for (bool half_diff : {false, true}) {
+    for (int64_t count : kModelSizes) {
+      const int64_t diff_size = half_diff ? sizeof(float16) : sizeof(float);
+      // reads model, model_diff, m and v, writes model, m and v
+      const int64_t bytes = count * (6 * sizeof(float) + diff_size);
+      RegisterBenchmark(
+          std::string("model_update/adam/") + (half_diff ? "half_diff/" : "float_diff/")
+              + std::to_string(count),
+          [=](BenchmarkContext* ctx) -> std::function<void()> {
+            float* model = static_cast<float*>(ctx->Alloc(DataType::kFloat, count));
+            float* m = static_cast<float*>(ctx->Alloc(DataType::kFloat, count));
+            float* v = static_cast<float*>(ctx->Alloc(DataType::kFloat, count));
+            void* model_diff =
+                ctx->Alloc(half_diff ? DataType::kFloat16 : DataType::kFloat, count);
+            return [=]() {
+              BangHandle handle = GetBangHandle(ctx);
+              if (half_diff) {
+                bang_adam_update_half_kernel<float>(
+                    handle, count, 1.f, 0.f, 0.f, 0.9f, 0.999f, 1e-8f, 0.f, false, true, 1e-3f,
+                    1.f, 1.f, 1.f, nullptr, nullptr, nullptr, nullptr, nullptr, model_diff, model,
+                    nullptr, m, v, nullptr);
+              } else {
+                bang_adam_update_kernel<float>(
+                    handle, count, 1.f, 0.f, 0.f, 0.9f, 0.999f, 1e-8f, 0.f, false, true, 1e-3f,
+                    1.f, 1.f, 1.f, nullptr, nullptr, nullptr, nullptr, nullptr,
+                    static_cast<const float*>(model_diff), model, nullptr, m, v, nullptr);
+              }
+            };
+          },
+          bytes);
+    }
+  }
+}
+
+}  // namespace
+
+REGISTER_MLU_BENCHMARKS(RegisterMemcpyReferenceBenchmarks);
+REGISTER_MLU_BENCHMARKS(RegisterMomentumUpdateBenchmarks);
+REGISTER_MLU_BENCHMARKS(RegisterAdamUpdateBenchmarks);
+
+}  // namespace benchmark
+}  // namespace mlu
+}  // namespace oneflow
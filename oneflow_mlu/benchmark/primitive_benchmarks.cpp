@@ -0,0 +1,276 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <numeric>
+
+#include "oneflow/core/common/scalar.h"
+#include "oneflow/core/ep/include/primitive/broadcast_elementwise_binary.h"
+#include "oneflow/core/ep/include/primitive/cast.h"
+#include "oneflow/core/ep/include/primitive/copy_nd.h"
+#include "oneflow/core/ep/include/primitive/elementwise_unary.h"
+#include "oneflow/core/ep/include/primitive/fill.h"
+#include "oneflow/core/ep/include/primitive/matmul.h"
+#include "oneflow/core/ep/include/primitive/memcpy.h"
+#include "oneflow/core/ep/include/primitive/memset.h"
+#include "oneflow/core/ep/include/primitive/permute.h"
+#include "oneflow/core/ep/include/primitive/where.h"
+#include "oneflow_mlu/benchmark/benchmark.h"
+
+namespace oneflow {
+namespace mlu {
+namespace benchmark {
+
+namespace {
+
+using ep::primitive::NewPrimitive;
+
+// Small sizes are dominated by host overhead, the large ones by device bandwidth.
+const std::vector<int64_t> kElementCounts = {64, 4096, 1 << 20, 1 << 24};
+
+const std::vector<std::pair<DataType, std::string>> kDataTypes = {
+    {DataType::kFloat, "float"}, {DataType::kFloat16, "half"}, {DataType::kInt64, "int64"}};
+
+int64_t ElementCount(const std::vector<int64_t>& shape) {
+  return std::accumulate(shape.begin(), shape.end(), int64_t(1), std::multiplies<int64_t>());
+}
+
+void RegisterFillBenchmarks() {
+  for (const auto& data_type : kDataTypes) {
+    for (int64_t count : kElementCounts) {
+      RegisterBenchmark(
+          "fill/" + data_type.second + "/" + std::to_string(count),
+          [=](BenchmarkContext* ctx) -> std::function<void()> {
+            std::shared_ptr<ep::primitive::Fill> fill =
+                NewPrimitive<ep::primitive::FillFactory>(DeviceType::kMLU, data_type.first);
+            if (!fill) { return nullptr; }
+            void* dst = ctx->Alloc(data_type.first, count);
+            return [=]() { fill->Launch(ctx->stream(), dst, Scalar(2), count); };
+          });
+    }
+  }
+}
+
+void RegisterMemsetAndMemcpyBenchmarks() {
+  for (int64_t count : kElementCounts) {
+    RegisterBenchmark("memset/" + std::to_string(count),
+                      [=](BenchmarkContext* ctx) -> std::function<void()> {
+                        std::shared_ptr<ep::primitive::Memset> memset =
+                            NewPrimitive<ep::primitive::MemsetFactory>(DeviceType::kMLU);
+                        if (!memset) { return nullptr; }
+                        void* dst = ctx->Alloc(DataType::kChar, count);
+                        return [=]() { memset->Launch(ctx->stream(), dst, 0, count); };
+                      });
+    RegisterBenchmark("memcpy_d2d/" + std::to_string(count),
+                      [=](BenchmarkContext* ctx) -> std::function<void()> {
+                        std::shared_ptr<ep::primitive::Memcpy> memcpy =
+                            NewPrimitive<ep::primitive::MemcpyFactory>(
+                                DeviceType::kMLU, ep::primitive::MemcpyKind::kDtoD);
+                        if (!memcpy) { return nullptr; }
+                        void* src = ctx->Alloc(DataType::kChar, count);
+                        void* dst = ctx->Alloc(DataType::kChar, count);
+                        return [=]() { memcpy->Launch(ctx->stream(), dst, src, count); };
+                      },
+                      2 * count);
+  }
+}
+
+void RegisterCastBenchmarks() {
+  const std::vector<std::pair<DataType, DataType>> casts = {
+      {DataType::kFloat, DataType::kFloat16},
+      {DataType::kFloat16, DataType::kFloat},
+      {DataType::kInt64, DataType::kFloat}};
+  for (const auto& cast_types : casts) {
+    for (int64_t count : kElementCounts) {
+      RegisterBenchmark("cast/" + DataType_Name(cast_types.first) + "_to_"
+                            + DataType_Name(cast_types.second) + "/" + std::to_string(count),
+                        [=](BenchmarkContext* ctx) -> std::function<void()> {
+                          std::shared_ptr<ep::primitive::Cast> cast =
+                              NewPrimitive<ep::primitive::CastFactory>(
+                                  DeviceType::kMLU, cast_types.first, cast_types.second);
+                          if (!cast) { return nullptr; }
+                          void* src = ctx->Alloc(cast_types.first, count);
+                          void* dst = ctx->Alloc(cast_types.second, count);
+                          return [=]() { cast->Launch(ctx->stream(), src, dst, count); };
+                        });
+    }
+  }
+}
+
+void RegisterElementwiseUnaryBenchmarks() {
+  const std::vector<std::pair<ep::primitive::UnaryOp, std::string>> ops = {
+      {ep::primitive::UnaryOp::kRelu, "relu"}, {ep::primitive::UnaryOp::kExp, "exp"}};
+  for (const auto& op : ops) {
+    for (const auto& data_type : kDataTypes) {
+      if (data_type.first == DataType::kInt64) { continue; }
+      for (int64_t count : kElementCounts) {
+        RegisterBenchmark(
+            "unary_" + op.second + "/" + data_type.second + "/" + std::to_string(count),
+            [=](BenchmarkContext* ctx) -> std::function<void()> {
+              std::shared_ptr<ep::primitive::ElementwiseUnary> unary =
+                  NewPrimitive<ep::primitive::ElementwiseUnaryFactory>(
+                      DeviceType::kMLU, op.first, data_type.first, data_type.first);
+              if (!unary) { return nullptr; }
+              void* src = ctx->Alloc(data_type.first, count);
+              void* dst = ctx->Alloc(data_type.first, count);
+              return [=]() { unary->Launch(ctx->stream(), src, dst, count); };
+            });
+      }
+    }
+  }
+}
+
+void RegisterBroadcastBinaryBenchmarks() {
+  // (src0 shape, src1 shape): same shape, row broadcast, scalar broadcast
+  const std::vector<std::pair<std::vector<int64_t>, std::vector<int64_t>>> shapes = {
+      {{64}, {64}},
+      {{1024, 1024}, {1024, 1024}},
+      {{1024, 1024}, {1, 1024}},
+      {{32, 64, 56, 56}, {1, 64, 1, 1}},
+      {{4096, 4096}, {1}}};
+  const std::vector<std::pair<ep::primitive::BinaryOp, std::string>> ops = {
+      {ep::primitive::BinaryOp::kAdd, "add"}, {ep::primitive::BinaryOp::kMul, "mul"}};
+  for (const auto& op : ops) {
+    for (const auto& data_type : kDataTypes) {
+      for (const auto& shape : shapes) {
+        RegisterBenchmark(
+            "broadcast_" + op.second + "/" + data_type.second + "/" + ShapeToString(shape.first)
+                + "_" + ShapeToString(shape.second),
+            [=](BenchmarkContext* ctx) -> std::function<void()> {
+              std::shared_ptr<ep::primitive::BroadcastElementwiseBinary> binary =
+                  NewPrimitive<ep::primitive::BroadcastElementwiseBinaryFactory>(
+                      DeviceType::kMLU, op.first, data_type.first, data_type.first,
+                      shape.first.size());
+              if (!binary) { return nullptr; }
+              const void* src0 = ctx->Alloc(data_type.first, ElementCount(shape.first));
+              const void* src1 = ctx->Alloc(data_type.first, ElementCount(shape.second));
+              void* dst = ctx->Alloc(data_type.first, ElementCount(shape.first));
+              return [=]() {
+                binary->Launch(ctx->stream(), shape.first.size(), shape.first.data(), src0,
+                               shape.second.size(), shape.second.data(), src1, dst);
+              };
+            });
+      }
+    }
+  }
+}
+
+void RegisterPermuteAndCopyNdBenchmarks() {
+  const std::vector<std::pair<std::vector<int64_t>, std::vector<int>>> permutes = {
+      {{1024, 1024}, {1, 0}},
+      {{32, 64, 56, 56}, {0, 2, 3, 1}},
+      {{8, 128, 16, 64}, {0, 2, 1, 3}}};
+  for (const auto& data_type : kDataTypes) {
+    for (const auto& permute : permutes) {
+      const std::vector<int64_t>& dims = permute.first;
+      const std::vector<int>& permutation = permute.second;
+      RegisterBenchmark(
+          "permute/" + data_type.second + "/" + ShapeToString(dims),
+          [=](BenchmarkContext* ctx) -> std::function<void()> {
+            std::shared_ptr<ep::primitive::Permute> primitive =
+                NewPrimitive<ep::primitive::PermuteFactory>(DeviceType::kMLU, dims.size());
+            if (!primitive) { return nullptr; }
+            const void* src = ctx->Alloc(data_type.first, ElementCount(dims));
+            void* dst = ctx->Alloc(data_type.first, ElementCount(dims));
+            return [=]() {
+              primitive->Launch(ctx->stream(), data_type.first, dims.size(), dims.data(), src,
+                                permutation.data(), dst);
+            };
+          });
+      // copy the inner half of every axis, the pattern produced by slice and pad
+      RegisterBenchmark(
+          "copy_nd/" + data_type.second + "/" + ShapeToString(dims),
+          [=](BenchmarkContext* ctx) -> std::function<void()> {
+            std::shared_ptr<ep::primitive::CopyNd> primitive =
+                NewPrimitive<ep::primitive::CopyNdFactory>(DeviceType::kMLU, dims.size());
+            if (!primitive) { return nullptr; }
+            std::vector<int64_t> pos(dims.size());
+            std::vector<int64_t> extent(dims.size());
+            for (size_t i = 0; i < dims.size(); ++i) {
+              pos[i] = dims[i] / 4;
+              extent[i] = dims[i] / 2;
+            }
+            const void* src = ctx->Alloc(data_type.first, ElementCount(dims));
+            void* dst = ctx->Alloc(data_type.first, ElementCount(dims));
+            return [=]() {
+              primitive->Launch(ctx->stream(), data_type.first, dims.size(), dst, dims.data(),
+                                pos.data(), src, dims.data(), pos.data(), extent.data());
+            };
+          });
+    }
+  }
+}
+
+void RegisterMatmulBenchmarks() {
+  const std::vector<std::vector<int64_t>> mnks = {
+      {1, 1024, 1024}, {64, 64, 64}, {1024, 1024, 1024}, {4096, 4096, 1024}};
+  for (const auto& data_type : kDataTypes) {
+    if (data_type.first == DataType::kInt64) { continue; }
+    for (const auto& mnk : mnks) {
+      RegisterBenchmark(
+          "matmul/" + data_type.second + "/" + ShapeToString(mnk),
+          [=](BenchmarkContext* ctx) -> std::function<void()> {
+            std::shared_ptr<ep::primitive::Matmul> matmul =
+                NewPrimitive<ep::primitive::MatmulFactory>(
+                    DeviceType::kMLU, data_type.first, ep::primitive::BlasTransposeType::N,
+                    ep::primitive::BlasTransposeType::N);
+            if (!matmul) { return nullptr; }
+            const int64_t m = mnk[0];
+            const int64_t n = mnk[1];
+            const int64_t k = mnk[2];
+            const void* a = ctx->Alloc(data_type.first, m * k);
+            const void* b = ctx->Alloc(data_type.first, k * n);
+            void* c = ctx->Alloc(data_type.first, m * n);
+            return [=]() { matmul->Launch(ctx->stream(), m, n, k, 1.0, a, b, 0.0, c); };
+          });
+    }
+  }
+}
+
+void RegisterWhereBenchmarks() {
+  for (const auto& data_type : kDataTypes) {
+    for (int64_t count : kElementCounts) {
+      RegisterBenchmark(
+          "where/" + data_type.second + "/" + std::to_string(count),
+          [=](BenchmarkContext* ctx) -> std::function<void()> {
+            std::shared_ptr<ep::primitive::Where> where =
+                NewPrimitive<ep::primitive::WhereFactory>(DeviceType::kMLU, DataType::kBool,
+                                                          data_type.first, 1);
+            if (!where) { return nullptr; }
+            const void* cond = ctx->Alloc(DataType::kBool, count);
+            const void* x = ctx->Alloc(data_type.first, count);
+            const void* y = ctx->Alloc(data_type.first, count);
+            void* z = ctx->Alloc(data_type.first, count);
+            return [=]() {
+              where->Launch(ctx->stream(), 1, &count, cond, 1, &count, x, 1, &count, y, z);
+            };
+          });
+    }
+  }
+}
+
+}  // namespace
+
+REGISTER_MLU_BENCHMARKS(RegisterFillBenchmarks);
+REGISTER_MLU_BENCHMARKS(RegisterMemsetAndMemcpyBenchmarks);
+REGISTER_MLU_BENCHMARKS(RegisterCastBenchmarks);
+REGISTER_MLU_BENCHMARKS(RegisterElementwiseUnaryBenchmarks);
+REGISTER_MLU_BENCHMARKS(RegisterBroadcastBinaryBenchmarks);
+REGISTER_MLU_BENCHMARKS(RegisterPermuteAndCopyNdBenchmarks);
+REGISTER_MLU_BENCHMARKS(RegisterMatmulBenchmarks);
+REGISTER_MLU_BENCHMARKS(RegisterWhereBenchmarks);
+
+}  // namespace benchmark
+}  // namespace mlu
+}  // namespace oneflow
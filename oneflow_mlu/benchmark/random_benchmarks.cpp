@@ -0,0 +1,145 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow_mlu/bang/bang_kernels.h"
+#include "oneflow_mlu/benchmark/benchmark.h"
+#include "oneflow_mlu/cnnl/cnnl_tensor_descriptor.h"
+#include "oneflow_mlu/common/mlu_util.h"
+
+namespace oneflow {
+namespace mlu {
+namespace benchmark {
+
+namespace {
+
+// The Philox kernels run their rounds on the scalar unit of each core. Every case has a vendor
+// counterpart on the MTGP32 generator they replaced, so --filter="random/.*" shows whether the
+// scalar rounds cost bandwidth compared to cnnlRandGenerateUniform and cnnlFusedDropout_v2.
+const std::vector<int64_t> kRandomSizes = {1 << 16, 1 << 20, 1 << 24};
+constexpr uint64_t kSeed = 2023;
+
+BangHandle GetBangHandle(BenchmarkContext* ctx) {
+  return BangHandle(ctx->stream()->mlu_stream(), ctx->device()->nclusters(),
+                    ctx->device()->ncores_per_cluster());
+}
+
+// MTGP32 generator and device state as the kernels used them before the Philox generator.
+struct Mtgp32Generator {
+  cnnlRandGenerator_t rng = nullptr;
+  void* state = nullptr;
+
+  explicit Mtgp32Generator(BenchmarkContext* ctx) {
+    OF_CNNL_CHECK(cnnlRandCreateGenerator(&rng, CNNL_RAND_RNG_MTGP32));
+    OF_CNNL_CHECK(cnnlRandSetPseudoRandomGeneratorSeed(rng, kSeed));
+    size_t state_size = 0;
+    OF_CNNL_CHECK(cnnlRandGetMTGP32StateSize(nullptr, &state_size));
+    state = ctx->Alloc(DataType::kChar, state_size);
+    OF_CNNL_CHECK(cnnlRandMakeMTGP32KernelState(ctx->stream()->cnnl_handle(), state, nullptr,
+                                                nullptr, kSeed));
+  }
+  ~Mtgp32Generator() { OF_CNNL_CHECK(cnnlRandDestroyGenerator(rng)); }
+};
+
+void RegisterUniformBenchmarks() {
+  for (int64_t count : kRandomSizes) {
+    const int64_t bytes = count * sizeof(float);
+    RegisterBenchmark(
+        "random/uniform/philox/" + std::to_string(count),
+        [=](BenchmarkContext* ctx) -> std::function<void()> {
+          float* out = static_cast<float*>(ctx->Alloc(DataType::kFloat, count));
+          return [=]() {
+            BangHandle handle = GetBangHandle(ctx);
+            bang_philox_uniform_kernel<float>(handle, count, kSeed, 0, 0.f, 1.f, out);
+          };
+        },
+        bytes);
+    RegisterBenchmark(
+        "random/uniform/mtgp32/" + std::to_string(count),
+        [=](BenchmarkContext* ctx) -> std::function<void()> {
+          auto generator = std::make_shared<Mtgp32Generator>(ctx);
+          void* out = ctx->Alloc(DataType::kFloat, count);
+          return [=]() {
+            OF_CNNL_CHECK(cnnlRandGenerateUniform(ctx->stream()->cnnl_handle(), generator->rng,
+                                                  CNNL_DTYPE_FLOAT, generator->state, count, 0.f,
+                                                  1.f, out));
+          };
+        },
+        bytes);
+  }
+}
+
+void RegisterDropoutBenchmarks() {
+  for (int64_t count : kRandomSizes) {
+    // reads in, writes out and a one byte mask
+    const int64_t bytes = count * (2 * sizeof(float) + sizeof(bool));
+    RegisterBenchmark(
+        "random/dropout/philox/" + std::to_string(count),
+        [=](BenchmarkContext* ctx) -> std::function<void()> {
+          const float* in = static_cast<const float*>(ctx->Alloc(DataType::kFloat, count));
+          float* out = static_cast<float*>(ctx->Alloc(DataType::kFloat, count));
+          bool* mask = static_cast<bool*>(ctx->Alloc(DataType::kBool, count));
+          return [=]() {
+            BangHandle handle = GetBangHandle(ctx);
+            bang_philox_dropout_kernel<float>(handle, count, kSeed, 0, 0.5f, in, mask, out);
+          };
+        },
+        bytes);
+    RegisterBenchmark(
+        "random/dropout/mtgp32/" + std::to_string(count),
+        [=](BenchmarkContext* ctx) -> std::function<void()> {
+          auto generator = std::make_shared<Mtgp32Generator>(ctx);
+          auto in_desc = std::make_shared<CnnlTensorDescriptor>();
+          auto out_desc = std::make_shared<CnnlTensorDescriptor>();
+          auto mask_desc = std::make_shared<CnnlTensorDescriptor>();
+          in_desc->set(1, &count, CNNL_DTYPE_FLOAT);
+          out_desc->set(1, &count, CNNL_DTYPE_FLOAT);
+          mask_desc->set(1, &count, CNNL_DTYPE_UINT8);
+          const void* in = ctx->Alloc(DataType::kFloat, count);
+          void* out = ctx->Alloc(DataType::kFloat, count);
+          void* mask = ctx->Alloc(DataType::kBool, count);
+          return [=]() {
+            OF_CNNL_CHECK(cnnlFusedDropout_v2(ctx->stream()->cnnl_handle(), generator->rng,
+                                              in_desc->desc(), in, 0.5f, generator->state,
+                                              mask_desc->desc(), mask, out_desc->desc(), out));
+          };
+        },
+        bytes);
+  }
+}
+
+void RegisterRandomMaskBenchmarks() {
+  for (int64_t count : kRandomSizes) {
+    RegisterBenchmark(
+        "random/random_mask/philox/" + std::to_string(count),
+        [=](BenchmarkContext* ctx) -> std::function<void()> {
+          bool* mask = static_cast<bool*>(ctx->Alloc(DataType::kBool, count));
+          return [=]() {
+            BangHandle handle = GetBangHandle(ctx);
+            bang_philox_random_mask_kernel(handle, count, kSeed, 0, 0.5f, mask);
+          };
+        },
+        count * sizeof(bool));
+  }
+}
+
+}  // namespace
+
+REGISTER_MLU_BENCHMARKS(RegisterUniformBenchmarks);
+REGISTER_MLU_BENCHMARKS(RegisterDropoutBenchmarks);
+REGISTER_MLU_BENCHMARKS(RegisterRandomMaskBenchmarks);
+
+}  // namespace benchmark
+}  // namespace mlu
+}  // namespace oneflow
@@ -19,6 +19,8 @@ limitations under the License.
 
 namespace oneflow {
 
+namespace {
+
 // modify tensor size and stride order based on
 // channels_first to channels_last or channels_last_3d.
 // which this is not same with pytorch original layout,
@@ -26,12 +28,13 @@ namespace oneflow {
 // example: modify channels_first tensor dim to cnnl nhwc tensor desc.
 //            N    C H W  -->   N    H W C
 //          C*H*W  1 W C  --> C*H*W  W C 1
-void convertShapeAndStride(std::vector<int>& shape_info, std::vector<int>& stride_info) {
+template<typename T>
+void ConvertShapeAndStrideImpl(std::vector<T>& shape_info, std::vector<T>& stride_info) {
   CHECK_EQ_OR_THROW(shape_info.size(), stride_info.size())
       << "shape size need equal to stride size.";
   const int dim = shape_info.size();
-  std::vector<int> temp_shape_info(dim);
-  std::vector<int> temp_stride_info(dim);
+  std::vector<T> temp_shape_info(dim);
+  std::vector<T> temp_stride_info(dim);
   temp_shape_info[0] = shape_info[0];
   temp_stride_info[0] = stride_info[0];
   for (size_t i = 0; i < dim - 1; ++i) {
@@ -43,4 +46,14 @@ void convertShapeAndStride(std::vector<int>& shape_info, std::vector<int>& strid
   stride_info.assign(temp_stride_info.begin(), temp_stride_info.end());
 }
 
+}  // namespace
+
+void convertShapeAndStride(std::vector<int>& shape_info, std::vector<int>& stride_info) {
+  ConvertShapeAndStrideImpl(shape_info, stride_info);
+}
+
+void convertShapeAndStride(std::vector<int64_t>& shape_info, std::vector<int64_t>& stride_info) {
+  ConvertShapeAndStrideImpl(shape_info, stride_info);
+}
+
 }  // namespace oneflow
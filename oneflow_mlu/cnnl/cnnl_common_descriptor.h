@@ -27,10 +27,78 @@ limitations under the License.
 
 namespace oneflow {
 
-template<typename T, cnnlStatus_t (*dtor)(T*)>
+// Only descriptor types that can be reset to their default state are recycled, so a pooled
+// descriptor never leaks settings from its previous user.
+template<typename T>
+struct CnnlDescriptorResetter {
+  static constexpr bool value = false;
+  static void Reset(T* ptr) {}
+};
+
+template<>
+struct CnnlDescriptorResetter<cnnlTensorStruct> {
+  static constexpr bool value = true;
+  static void Reset(cnnlTensorStruct* ptr) { OF_CNNL_CHECK(cnnlResetTensorDescriptor(ptr)); }
+};
+
+// Per-thread free list of descriptors. Kernels build several short-lived descriptors in every
+// Compute, recycling them avoids a cnnlCreate/cnnlDestroy pair per descriptor per launch.
+template<typename T, cnnlStatus_t (*ctor)(T**), cnnlStatus_t (*dtor)(T*)>
+class CnnlDescriptorPool {
+ public:
+  static T* Acquire() {
+    if (CnnlDescriptorResetter<T>::value) {
+      CnnlDescriptorPool* pool = Get();
+      if (pool != nullptr && !pool->free_list_.empty()) {
+        T* ptr = pool->free_list_.back();
+        pool->free_list_.pop_back();
+        return ptr;
+      }
+    }
+    T* ptr;
+    OF_CNNL_CHECK(ctor(&ptr));
+    return ptr;
+  }
+
+  static void Release(T* ptr) {
+    if (CnnlDescriptorResetter<T>::value) {
+      CnnlDescriptorPool* pool = Get();
+      if (pool != nullptr && pool->free_list_.size() < kMaxPooledDescriptors) {
+        CnnlDescriptorResetter<T>::Reset(ptr);
+        pool->free_list_.push_back(ptr);
+        return;
+      }
+    }
+    OF_CNNL_CHECK(dtor(ptr));
+  }
+
+ private:
+  static constexpr size_t kMaxPooledDescriptors = 64;
+
+  explicit CnnlDescriptorPool(bool* destroyed) : destroyed_(destroyed) {}
+  ~CnnlDescriptorPool() {
+    *destroyed_ = true;
+    for (T* ptr : free_list_) { OF_CNNL_CHECK(dtor(ptr)); }
+  }
+
+  // Returns nullptr once the pool of this thread is destroyed, descriptors released by later
+  // thread_local destructors are then destroyed directly. The flag is trivially destructible so
+  // it stays readable after the pool is gone.
+  static CnnlDescriptorPool* Get() {
+    thread_local bool destroyed = false;
+    if (destroyed) { return nullptr; }
+    thread_local CnnlDescriptorPool pool(&destroyed);
+    return &pool;
+  }
+
+  bool* destroyed_;
+  std::vector<T*> free_list_;
+};
+
+template<typename T, cnnlStatus_t (*ctor)(T**), cnnlStatus_t (*dtor)(T*)>
 struct CnnlDescriptorDeleter {
   void operator()(T* ptr) {
-    if (ptr != nullptr) { OF_CNNL_CHECK(dtor(ptr)); }
+    if (ptr != nullptr) { CnnlDescriptorPool<T, ctor, dtor>::Release(ptr); }
   }
 };
 
@@ -57,18 +125,15 @@ class CnnlDescriptor {
 
  protected:
   void init() {
-    if (desc_ == nullptr) {
-      T* ptr;
-      OF_CNNL_CHECK(ctor(&ptr));
-      desc_.reset(ptr);
-    }
+    if (desc_ == nullptr) { desc_.reset(CnnlDescriptorPool<T, ctor, dtor>::Acquire()); }
   }
 
  private:
-  std::unique_ptr<T, CnnlDescriptorDeleter<T, dtor> > desc_;
+  std::unique_ptr<T, CnnlDescriptorDeleter<T, ctor, dtor> > desc_;
 };
 
 void convertShapeAndStride(std::vector<int>& shape_info, std::vector<int>& stride_info);
+void convertShapeAndStride(std::vector<int64_t>& shape_info, std::vector<int64_t>& stride_info);
 
 }  // namespace oneflow
 
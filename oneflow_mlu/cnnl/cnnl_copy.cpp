@@ -0,0 +1,78 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow_mlu/cnnl/cnnl_copy.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "oneflow_mlu/cnnl/cnnl_tensor_descriptor.h"
+
+namespace oneflow {
+
+namespace {
+
+bool IsDescribable(int ndim, const int64_t* extent, const int64_t* src_strides,
+                   const int64_t* dst_strides) {
+  return IsCnnlDescribable(ndim, extent, src_strides)
+         && IsCnnlDescribable(ndim, extent, dst_strides);
+}
+
+void StridedCopyImpl(cnnlHandle_t handle, cnnlDataType_t cnnl_data_type, int64_t elem_size,
+                     int ndim, const int64_t* extent, const char* src, const int64_t* src_strides,
+                     char* dst, const int64_t* dst_strides) {
+  if (IsDescribable(ndim, extent, src_strides, dst_strides)) {
+    CnnlTensorDescriptor src_desc, dst_desc;
+    src_desc.set(ndim, extent, src_strides, cnnl_data_type);
+    dst_desc.set(ndim, extent, dst_strides, cnnl_data_type);
+    OF_CNNL_CHECK(cnnlCopy(handle, src_desc.desc(), src, dst_desc.desc(), dst));
+    return;
+  }
+  // halve the outermost extent until one chunk fits, a single row always reduces to ndim - 1
+  std::vector<int64_t> chunk_extent(extent, extent + ndim);
+  while (chunk_extent[0] > 1
+         && !IsDescribable(ndim, chunk_extent.data(), src_strides, dst_strides)) {
+    chunk_extent[0] = (chunk_extent[0] + 1) / 2;
+  }
+  const bool fits = IsDescribable(ndim, chunk_extent.data(), src_strides, dst_strides);
+  CHECK_OR_THROW(fits || ndim > 1) << "strided copy can not be split into describable chunks";
+  for (int64_t i = 0; i < extent[0]; i += chunk_extent[0]) {
+    const char* chunk_src = src + i * src_strides[0] * elem_size;
+    char* chunk_dst = dst + i * dst_strides[0] * elem_size;
+    if (fits) {
+      chunk_extent[0] = std::min(chunk_extent[0], extent[0] - i);
+      StridedCopyImpl(handle, cnnl_data_type, elem_size, ndim, chunk_extent.data(), chunk_src,
+                      src_strides, chunk_dst, dst_strides);
+    } else {
+      StridedCopyImpl(handle, cnnl_data_type, elem_size, ndim - 1, extent + 1, chunk_src,
+                      src_strides + 1, chunk_dst, dst_strides + 1);
+    }
+  }
+}
+
+}  // namespace
+
+void CnnlStridedCopy(ep::MluStream* stream, DataType data_type, int ndim, const int64_t* extent,
+                     const void* src, const int64_t* src_strides, void* dst,
+                     const int64_t* dst_strides) {
+  for (int i = 0; i < ndim; ++i) {
+    if (extent[i] == 0) { return; }
+  }
+  StridedCopyImpl(stream->cnnl_handle(), ConvertToCnnlDataType(data_type),
+                  GetSizeOfDataType(data_type), ndim, extent, static_cast<const char*>(src),
+                  src_strides, static_cast<char*>(dst), dst_strides);
+}
+
+}  // namespace oneflow
@@ -0,0 +1,33 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CAMBRICON_CNNL_CNNL_COPY_H_
+#define ONEFLOW_CAMBRICON_CNNL_CNNL_COPY_H_
+
+#include "oneflow/core/common/data_type.h"
+#include "oneflow_mlu/ep/mlu_stream.h"
+
+namespace oneflow {
+
+// Copies an `extent` shaped region between two strided buffers with cnnlCopy. When the linked CNNL
+// only has int tensor descriptors and a side spans more than 2^31 - 1 elements, the copy is split
+// along the outer axes into chunks that can be described.
+void CnnlStridedCopy(ep::MluStream* stream, DataType data_type, int ndim, const int64_t* extent,
+                     const void* src, const int64_t* src_strides, void* dst,
+                     const int64_t* dst_strides);
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CAMBRICON_CNNL_CNNL_COPY_H_
@@ -15,6 +15,10 @@ limitations under the License.
 */
 #include "oneflow_mlu/cnnl/cnnl_tensor_descriptor.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
 #include "oneflow/core/common/throw.h"
 #include "oneflow/core/common/tensor_meta.h"
 
@@ -23,9 +27,116 @@ limitations under the License.
 
 namespace oneflow {
 
+namespace {
+
+#if !ONEFLOW_MLU_CNNL_INT64_TENSOR_DESCRIPTOR
+bool FitsInInt(int64_t value) {
+  return value >= std::numeric_limits<int>::min() && value <= std::numeric_limits<int>::max();
+}
+
+std::vector<int> NarrowToInt(int ndim, const int64_t* values) {
+  std::vector<int> narrowed(ndim);
+  for (int i = 0; i < ndim; ++i) {
+    CHECK_OR_THROW(FitsInInt(values[i]))
+        << "value " << values[i] << " at axis " << i
+        << " exceeds the int range of this CNNL release, which has no int64 tensor descriptor";
+    narrowed[i] = static_cast<int>(values[i]);
+  }
+  return narrowed;
+}
+#endif
+
+}  // namespace
+
+bool IsCnnlDescribable(int ndim, const int64_t* shape, const int64_t* stride) {
+#if ONEFLOW_MLU_CNNL_INT64_TENSOR_DESCRIPTOR
+  return true;
+#else
+  int64_t max_offset = 0;
+  for (int i = 0; i < ndim; ++i) {
+    if (!FitsInInt(shape[i]) || !FitsInInt(stride[i])) { return false; }
+    if (shape[i] > 0) { max_offset += (shape[i] - 1) * std::abs(stride[i]); }
+  }
+  return FitsInInt(max_offset);
+#endif
+}
+
+bool GetBroadcastSourceDims(int ndim, const int64_t* shape, const int64_t* stride,
+                            int64_t* source_dims) {
+  bool has_zero_stride = false;
+  int64_t expected_stride = 1;
+  for (int i = ndim - 1; i >= 0; --i) {
+    if (shape[i] != 1 && stride[i] == 0) {
+      has_zero_stride = true;
+      source_dims[i] = 1;
+      continue;
+    }
+    source_dims[i] = shape[i];
+    if (shape[i] == 1) { continue; }
+    if (stride[i] != expected_stride) { return false; }
+    expected_stride *= shape[i];
+  }
+  return has_zero_stride;
+}
+
+void CnnlTensorDescriptor::SetScalar(cnnlDataType_t data_type) {
+  const int64_t dim_array[1] = {1};
+  SetShapeAndStride(CNNL_LAYOUT_ARRAY, data_type, 1, dim_array, dim_array);
+}
+
+bool CnnlTensorDescriptor::IsSameShapeAndStride(cnnlTensorLayout_t layout,
+                                                cnnlDataType_t data_type, int ndim,
+                                                const int64_t* shape, const int64_t* stride) const {
+  if (cached_ndim_ != ndim || cached_layout_ != layout || cached_data_type_ != data_type) {
+    return false;
+  }
+  for (int i = 0; i < ndim; ++i) {
+    if (cached_shape_[i] != shape[i] || cached_stride_[i] != stride[i]) { return false; }
+  }
+  return true;
+}
+
+void CnnlTensorDescriptor::SetShapeAndStride(cnnlTensorLayout_t layout, cnnlDataType_t data_type,
+                                             int ndim, const int64_t* shape,
+                                             const int64_t* stride) {
+  if (desc() != nullptr && IsSameShapeAndStride(layout, data_type, ndim, shape, stride)) {
+    return;
+  }
+#if ONEFLOW_MLU_CNNL_INT64_TENSOR_DESCRIPTOR
+  OF_CNNL_CHECK(
+      cnnlSetTensorDescriptorEx_v2(this->mut_desc(), layout, data_type, ndim, shape, stride));
+#else
+  std::vector<int> shape_info = NarrowToInt(ndim, shape);
+  std::vector<int> stride_info = NarrowToInt(ndim, stride);
+  OF_CNNL_CHECK(cnnlSetTensorDescriptorEx(this->mut_desc(), layout, data_type, ndim,
+                                          shape_info.data(), stride_info.data()));
+#endif
+  if (ndim <= kMaxCachedNumDims) {
+    cached_ndim_ = ndim;
+    cached_layout_ = layout;
+    cached_data_type_ = data_type;
+    std::copy(shape, shape + ndim, cached_shape_);
+    std::copy(stride, stride + ndim, cached_stride_);
+  } else {
+    cached_ndim_ = -1;
+  }
+}
+
+void CnnlTensorDescriptor::SetShape(cnnlTensorLayout_t layout, cnnlDataType_t data_type, int ndim,
+                                    const int64_t* shape) {
+  cached_ndim_ = -1;
+#if ONEFLOW_MLU_CNNL_INT64_TENSOR_DESCRIPTOR
+  OF_CNNL_CHECK(cnnlSetTensorDescriptor_v2(this->mut_desc(), layout, data_type, ndim, shape));
+#else
+  std::vector<int> shape_info = NarrowToInt(ndim, shape);
+  OF_CNNL_CHECK(
+      cnnlSetTensorDescriptor(this->mut_desc(), layout, data_type, ndim, shape_info.data()));
+#endif
+}
+
 void CnnlTensorDescriptor::set_reduce(const user_op::Tensor* t) {
   int t_dim = t->shape_view().NumAxes();
-  std::vector<int> dim_array;
+  std::vector<int64_t> dim_array;
   if (t_dim == 0) {
     t_dim = 1;
     dim_array.push_back(1);
@@ -34,12 +145,11 @@ void CnnlTensorDescriptor::set_reduce(const user_op::Tensor* t) {
     for (int i = 0; i < t_dim; i++) { dim_array.push_back(shape.At(i)); }
   }
   auto data_type = ConvertToCnnlDataType(t->data_type());
-  OF_CNNL_CHECK(cnnlSetTensorDescriptor(this->mut_desc(), CNNL_LAYOUT_NCHW, data_type, t_dim,
-                                        dim_array.data()));
+  SetShape(CNNL_LAYOUT_NCHW, data_type, t_dim, dim_array.data());
 }
 void CnnlTensorDescriptor::set_reduce(const user_op::Tensor* t, std::vector<int64_t> keepdim) {
   int t_dim = keepdim.size();
-  std::vector<int> dim_array;
+  std::vector<int64_t> dim_array;
   if (t_dim == 0) {
     t_dim = 1;
     dim_array.push_back(1);
@@ -47,8 +157,7 @@ void CnnlTensorDescriptor::set_reduce(const user_op::Tensor* t, std::vector<int6
     for (int i = 0; i < t_dim; i++) { dim_array.push_back(keepdim[i]); }
   }
   auto data_type = ConvertToCnnlDataType(t->data_type());
-  OF_CNNL_CHECK(cnnlSetTensorDescriptor(this->mut_desc(), CNNL_LAYOUT_NCHW, data_type, t_dim,
-                                        dim_array.data()));
+  SetShape(CNNL_LAYOUT_NCHW, data_type, t_dim, dim_array.data());
 }
 
 void CnnlTensorDescriptor::set(const user_op::Tensor* t) {
@@ -59,21 +168,12 @@ void CnnlTensorDescriptor::set(const user_op::Tensor* t) {
 void CnnlTensorDescriptor::set(const user_op::Tensor* t, cnnlDataType_t data_type) {
   int t_dim = t->shape_view().NumAxes();
   if (!t_dim) {
-    t_dim = 1;
-    std::vector<int> dim_array(1, 1);
     // (sg) change CNNL_LAYOUT_NHWC to CNNL_LAYOUT_ARRAY?
-    OF_CNNL_CHECK(cnnlSetTensorDescriptorEx(this->mut_desc(), CNNL_LAYOUT_ARRAY, data_type, t_dim,
-                                            dim_array.data(), dim_array.data()));
+    SetScalar(data_type);
     return;
   }
-  std::vector<int> shape_info(t_dim);
-  std::vector<int> stride_info(t_dim);
-  for (size_t i = 0; i < t_dim; ++i) {
-    shape_info[i] = static_cast<int>(t->shape_view().At(i));
-    stride_info[i] = static_cast<int>(t->stride()[i]);
-  }
-  OF_CNNL_CHECK(cnnlSetTensorDescriptorEx(this->mut_desc(), CNNL_LAYOUT_ARRAY, data_type, t_dim,
-                                          shape_info.data(), stride_info.data()));
+  SetShapeAndStride(CNNL_LAYOUT_ARRAY, data_type, t_dim, t->shape_view().ptr(),
+                    t->stride().data());
 }
 
 void CnnlTensorDescriptor::set(const user_op::Tensor* t, cnnlTensorLayout_t layout,
@@ -81,48 +181,54 @@ void CnnlTensorDescriptor::set(const user_op::Tensor* t, cnnlTensorLayout_t layo
   int t_dim = t->shape_view().NumAxes();
   if (data_type == CNNL_DTYPE_INVALID) { data_type = ConvertToCnnlDataType(t->data_type()); }
   if (!t_dim) {
-    t_dim = 1;
-    std::vector<int> dim_array(1, 1);
-    OF_CNNL_CHECK(cnnlSetTensorDescriptorEx(this->mut_desc(), CNNL_LAYOUT_ARRAY, data_type, t_dim,
-                                            dim_array.data(), dim_array.data()));
+    SetScalar(data_type);
     return;
   }
-  std::vector<int> shape_info(t_dim);
-  std::vector<int> stride_info(t_dim);
+  std::vector<int64_t> shape_info(t_dim);
+  std::vector<int64_t> stride_info(t_dim);
   if (layout == CNNL_LAYOUT_NHWC || layout == CNNL_LAYOUT_NDHWC || layout == CNNL_LAYOUT_NLC) {
     for (size_t i = 0; i < t_dim; ++i) {
-      shape_info[i] = static_cast<int>(t->shape_view().At(i));
-      stride_info[i] = static_cast<int>(t->stride()[i]);
+      shape_info[i] = t->shape_view().At(i);
+      stride_info[i] = t->stride()[i];
     }
     convertShapeAndStride(shape_info, stride_info);
   } else if (layout == CNNL_LAYOUT_HWCN) {
     // HWCN is only used by depthwise conv now, and the dim is 4
     CHECK_EQ_OR_THROW(t_dim, 4) << "depthwise convolution input's dim must be 4";
-    auto convertDepthWiseConvShapeStride = [](const int64_t* vec, std::vector<int>& target_vec) {
-      target_vec[0] = static_cast<int>(vec[2]);
-      target_vec[1] = static_cast<int>(vec[3]);
-      target_vec[2] = static_cast<int>(vec[1]);
-      target_vec[3] = static_cast<int>(vec[0]);
+    auto convertDepthWiseConvShapeStride = [](const int64_t* vec,
+                                              std::vector<int64_t>& target_vec) {
+      target_vec[0] = vec[2];
+      target_vec[1] = vec[3];
+      target_vec[2] = vec[1];
+      target_vec[3] = vec[0];
     };
     convertDepthWiseConvShapeStride(t->shape_view().ptr(), shape_info);
     convertDepthWiseConvShapeStride(t->stride().data(), stride_info);
-  } else if (layout == CNNL_LAYOUT_TNC) {
-    // TNC layout is similar to ARRAY
-    for (size_t i = 0; i < t_dim; ++i) {
-      shape_info[i] = static_cast<int>(t->shape_view().At(i));
-      stride_info[i] = static_cast<int>(t->stride()[i]);
-    }
   } else {
+    // TNC layout is similar to ARRAY
     for (size_t i = 0; i < t_dim; ++i) {
-      shape_info[i] = static_cast<int>(t->shape_view().At(i));
-      stride_info[i] = static_cast<int>(t->stride()[i]);
+      shape_info[i] = t->shape_view().At(i);
+      stride_info[i] = t->stride()[i];
     }
   }
-  OF_CNNL_CHECK(cnnlSetTensorDescriptorEx(this->mut_desc(), layout, data_type, t_dim,
-                                          shape_info.data(), stride_info.data()));
+  SetShapeAndStride(layout, data_type, t_dim, shape_info.data(), stride_info.data());
+}
+
+bool CnnlTensorDescriptor::set_broadcast_source(const user_op::Tensor* t) {
+  const int ndim = t->shape_view().NumAxes();
+  if (ndim == 0) { return false; }
+  std::vector<int64_t> source_dims(ndim);
+  if (!GetBroadcastSourceDims(ndim, t->shape_view().ptr(), t->stride().data(),
+                              source_dims.data())) {
+    return false;
+  }
+  set(ndim, source_dims.data(), ConvertToCnnlDataType(t->data_type()));
+  return true;
 }
 
 void CnnlTensorDescriptor::set(int position, float scale) {
+  // the cache only covers layout, dtype, shape and stride, so the next set calls CNNL again
+  cached_ndim_ = -1;
   if (scale == 1.0f) {
     OF_CNNL_CHECK(cnnlSetTensorDescriptorPosition(this->mut_desc(), position));
   } else {
@@ -131,23 +237,25 @@ void CnnlTensorDescriptor::set(int position, float scale) {
 }
 
 void CnnlTensorDescriptor::set_onchip_dtype(cnnlDataType_t onchip_dtype) {
+  cached_ndim_ = -1;
   OF_CNNL_CHECK(cnnlSetTensorDescriptorOnchipDataType(this->mut_desc(), onchip_dtype));
 }
 
 void CnnlTensorDescriptor::set_additional_dim(const user_op::Tensor* t, std::vector<int>& dims) {
   const int dim = dims.size();
   cnnlDataType_t data_type = ConvertToCnnlDataType(t->data_type());
-  std::vector<int> stride_info(dim);
-  int value = 1;
+  std::vector<int64_t> shape_info(dims.begin(), dims.end());
+  std::vector<int64_t> stride_info(dim);
+  int64_t value = 1;
   for (size_t i = dim - 1; i > 0; --i) {
     stride_info[i] = value;
-    value *= dims[i];
+    value *= shape_info[i];
   }
   stride_info[0] = value;
   // NCHW -> NHWC layout
-  convertShapeAndStride(dims, stride_info);
-  OF_CNNL_CHECK(cnnlSetTensorDescriptorEx(this->mut_desc(), CNNL_LAYOUT_NHWC, data_type, dim,
-                                          dims.data(), stride_info.data()));
+  convertShapeAndStride(shape_info, stride_info);
+  for (int i = 0; i < dim; ++i) { dims[i] = static_cast<int>(shape_info[i]); }
+  SetShapeAndStride(CNNL_LAYOUT_NHWC, data_type, dim, shape_info.data(), stride_info.data());
 }
 
 void CnnlTensorDescriptor::set_reshape(const user_op::Tensor* t, const std::vector<int>& dims) {
@@ -156,15 +264,15 @@ void CnnlTensorDescriptor::set_reshape(const user_op::Tensor* t, const std::vect
       << "set_reshape(): tensor must be contiguous";
   const int dim = dims.size();
   cnnlDataType_t data_type = ConvertToCnnlDataType(t->data_type());
-  std::vector<int> stride_info(dim);
-  int value = 1;
+  std::vector<int64_t> shape_info(dims.begin(), dims.end());
+  std::vector<int64_t> stride_info(dim);
+  int64_t value = 1;
   for (size_t i = dim - 1; i > 0; --i) {
     stride_info[i] = value;
-    value *= dims.at(i);
+    value *= shape_info[i];
   }
   stride_info[0] = value;
-  OF_CNNL_CHECK(cnnlSetTensorDescriptorEx(this->mut_desc(), CNNL_LAYOUT_NCHW, data_type, dim,
-                                          dims.data(), stride_info.data()));
+  SetShapeAndStride(CNNL_LAYOUT_NCHW, data_type, dim, shape_info.data(), stride_info.data());
 }
 
 // Just for pooling
@@ -173,18 +281,18 @@ void CnnlTensorDescriptor::set(const user_op::Tensor* t, bool keep_dim,
   if (data_type == CNNL_DTYPE_INVALID) { data_type = ConvertToCnnlDataType(t->data_type()); }
   int t_dim = t->shape_view().NumAxes();
   if (!keep_dim) { t_dim = keepdim_sizes.size(); }
-  std::vector<int> shape_info(t_dim);
-  std::vector<int> stride_info(t_dim);
+  std::vector<int64_t> shape_info(t_dim);
+  std::vector<int64_t> stride_info(t_dim);
   for (size_t i = 0; i < t_dim; ++i) {
     if (keep_dim) {
-      shape_info[i] = static_cast<int>(t->shape_view().At(i));
-      stride_info[i] = static_cast<int>(t->stride()[i]);
+      shape_info[i] = t->shape_view().At(i);
+      stride_info[i] = t->stride()[i];
     } else {
-      shape_info[i] = static_cast<int>(keepdim_sizes[i]);
+      shape_info[i] = keepdim_sizes[i];
     }
   }
   if (!keep_dim) {
-    int value = 1;
+    int64_t value = 1;
     for (size_t i = t_dim - 1; i > 0; --i) {
       stride_info[i] = value;
       value *= shape_info[i];
@@ -192,42 +300,36 @@ void CnnlTensorDescriptor::set(const user_op::Tensor* t, bool keep_dim,
     stride_info[0] = value;
   }
   convertShapeAndStride(shape_info, stride_info);
-  OF_CNNL_CHECK(cnnlSetTensorDescriptorEx(this->mut_desc(), CNNL_LAYOUT_ARRAY, data_type, t_dim,
-                                          shape_info.data(), stride_info.data()));
+  SetShapeAndStride(CNNL_LAYOUT_ARRAY, data_type, t_dim, shape_info.data(), stride_info.data());
 }
 
 void CnnlTensorDescriptor::set_dim(const user_op::Tensor* t, int inputDim) {
   cnnlDataType_t data_type = ConvertToCnnlDataType(t->data_type());
   int t_dim = t->shape_view().NumAxes();
   if (!t_dim) {
-    t_dim = 1;
-    std::vector<int> dim_array(1, 1);
-    OF_CNNL_CHECK(cnnlSetTensorDescriptorEx(this->mut_desc(), CNNL_LAYOUT_ARRAY, data_type, t_dim,
-                                            dim_array.data(), dim_array.data()));
+    SetScalar(data_type);
     return;
   }
-  std::vector<int> cur_size(t_dim);
-  for (size_t i = 0; i < t_dim; ++i) { cur_size[i] = static_cast<int>(t->shape_view().At(i)); }
   CHECK_EQ_OR_THROW(inputDim, 4) << "inputDim need equal to 4.";
-  std::vector<int> cnnl_shape_size(inputDim, 1);
-  std::vector<int> cnnl_stride_size(inputDim, 1);
-  for (size_t i = 0; i < inputDim; ++i) { cnnl_shape_size[i] = t_dim > i ? cur_size[i] : 1; }
+  std::vector<int64_t> cnnl_shape_size(inputDim, 1);
+  std::vector<int64_t> cnnl_stride_size(inputDim, 1);
+  for (size_t i = 0; i < inputDim; ++i) {
+    cnnl_shape_size[i] = t_dim > i ? t->shape_view().At(i) : 1;
+  }
   cnnl_stride_size[3] = 1;
   cnnl_stride_size[2] = cnnl_shape_size[3];
   cnnl_stride_size[1] = cnnl_stride_size[2] * cnnl_shape_size[2];
   cnnl_stride_size[0] = cnnl_stride_size[1] * cnnl_shape_size[1];
-  OF_CNNL_CHECK(cnnlSetTensorDescriptorEx(this->mut_desc(), CNNL_LAYOUT_ARRAY, data_type, inputDim,
-                                          cnnl_shape_size.data(), cnnl_stride_size.data()));
+  SetShapeAndStride(CNNL_LAYOUT_ARRAY, data_type, inputDim, cnnl_shape_size.data(),
+                    cnnl_stride_size.data());
 }
 
 void CnnlTensorDescriptor::set_dim(const user_op::Tensor* t) {
   const int inputDim = 1;
   cnnlDataType_t data_type = ConvertToCnnlDataType(t->data_type());
-  std::vector<int> cnnl_size;
-  cnnl_size.push_back(t->shape_view().elem_cnt());
-  std::vector<int> stride_size = {1};
-  OF_CNNL_CHECK(cnnlSetTensorDescriptorEx(this->mut_desc(), CNNL_LAYOUT_ARRAY, data_type, inputDim,
-                                          cnnl_size.data(), stride_size.data()));
+  const int64_t cnnl_size[1] = {t->shape_view().elem_cnt()};
+  const int64_t stride_size[1] = {1};
+  SetShapeAndStride(CNNL_LAYOUT_ARRAY, data_type, inputDim, cnnl_size, stride_size);
 }
 
 void CnnlSeqDataDescriptor::set(const user_op::Tensor* t) {
@@ -24,8 +24,26 @@ limitations under the License.
 // Modified from Cambricon catch for PyTorch.
 // https://github.com/Cambricon/catch/blob/main/torch_mlu/csrc/aten/cnnl/cnnlTensorDescriptors.h
 
+// cnnlSetTensorDescriptor_v2 and cnnlSetTensorDescriptorEx_v2 take int64 shape and stride, older
+// releases only accept int and cannot describe tensors with more than 2^31 - 1 elements.
+#if CNNL_MAJOR > 1 || (CNNL_MAJOR == 1 && CNNL_MINOR >= 13)
+#define ONEFLOW_MLU_CNNL_INT64_TENSOR_DESCRIPTOR 1
+#else
+#define ONEFLOW_MLU_CNNL_INT64_TENSOR_DESCRIPTOR 0
+#endif
+
 namespace oneflow {
 
+// Returns true if a tensor with the given shape and stride can be described by the linked CNNL,
+// i.e. always with int64 descriptors, otherwise only when every element offset fits in int.
+bool IsCnnlDescribable(int ndim, const int64_t* shape, const int64_t* stride);
+
+// Returns true if a tensor is a stride-0 view of a contiguous source, i.e. expand or
+// broadcast_like run as a view, and writes the dims of that source with every stride-0 axis
+// folded to 1. Consumers can then read the small source and broadcast it themselves.
+bool GetBroadcastSourceDims(int ndim, const int64_t* shape, const int64_t* stride,
+                            int64_t* source_dims);
+
 class CnnlTensorDescriptor : public CnnlDescriptor<cnnlTensorStruct, &cnnlCreateTensorDescriptor,
                                                    &cnnlDestroyTensorDescriptor> {
  public:
@@ -48,6 +66,9 @@ class CnnlTensorDescriptor : public CnnlDescriptor<cnnlTensorStruct, &cnnlCreate
   void set(const user_op::Tensor* t, cnnlDataType_t dtype);
   void set_onchip_dtype(cnnlDataType_t data_type);
   void set(int position = 0, float scale = 1.0);
+  // Describes the contiguous source of a stride-0 view and returns true, returns false and leaves
+  // the descriptor untouched for any other tensor.
+  bool set_broadcast_source(const user_op::Tensor* t);
 
   void set_dim(const user_op::Tensor* t);
   void set_dim(const user_op::Tensor* t, int inputDim);
@@ -78,65 +99,73 @@ class CnnlTensorDescriptor : public CnnlDescriptor<cnnlTensorStruct, &cnnlCreate
     // tensor dtype value when data_type value is default.
     if (data_type == CNNL_DTYPE_INVALID) { data_type = ConvertToCnnlDataType(t->data_type()); }
     if (!t_dim) {
-      t_dim = 1;
-      std::vector<int> dim_array(1, 1);
-      OF_CNNL_CHECK(cnnlSetTensorDescriptorEx(this->mut_desc(), CNNL_LAYOUT_ARRAY, data_type, t_dim,
-                                              dim_array.data(), dim_array.data()));
+      SetScalar(data_type);
       return;
     }
-    std::vector<int> real_shape_info(t_dim);
-    std::vector<int> real_stride_info(t_dim);
+    std::vector<int64_t> real_shape_info(t_dim);
+    std::vector<int64_t> real_stride_info(t_dim);
     for (int i = 0; i < t_dim; ++i) {
-      real_shape_info[i] = static_cast<int>(shape_info[i]);
-      real_stride_info[i] = static_cast<int>(stride_info[i]);
+      real_shape_info[i] = static_cast<int64_t>(shape_info[i]);
+      real_stride_info[i] = static_cast<int64_t>(stride_info[i]);
     }
-    OF_CNNL_CHECK(cnnlSetTensorDescriptorEx(this->mut_desc(), layout, data_type, t_dim,
-                                            real_shape_info.data(), real_stride_info.data()));
+    SetShapeAndStride(layout, data_type, t_dim, real_shape_info.data(), real_stride_info.data());
   }
 
   template<typename T>
   void set(int ndim, const T* shape, cnnlDataType_t data_type,
            cnnlTensorLayout_t layout = CNNL_LAYOUT_ARRAY) {
     if (!ndim) {
-      ndim = 1;
-      std::vector<int> shape_info(1, 1);
-      OF_CNNL_CHECK(cnnlSetTensorDescriptorEx(this->mut_desc(), CNNL_LAYOUT_ARRAY, data_type, ndim,
-                                              shape_info.data(), shape_info.data()));
+      SetScalar(data_type);
       return;
     }
-    std::vector<int> shape_info(ndim, 1);
-    std::vector<int> stride_info(ndim, 1);
-    int value = 1;
+    std::vector<int64_t> shape_info(ndim, 1);
+    std::vector<int64_t> stride_info(ndim, 1);
+    int64_t value = 1;
     for (size_t i = ndim - 1; i > 0; --i) {
-      shape_info[i] = static_cast<int>(shape[i]);
+      shape_info[i] = static_cast<int64_t>(shape[i]);
       stride_info[i] = value;
       value *= shape_info[i];
     }
-    shape_info[0] = static_cast<int>(shape[0]);
+    shape_info[0] = static_cast<int64_t>(shape[0]);
     stride_info[0] = value;
-    OF_CNNL_CHECK(cnnlSetTensorDescriptorEx(this->mut_desc(), layout, data_type, ndim,
-                                            shape_info.data(), stride_info.data()));
+    SetShapeAndStride(layout, data_type, ndim, shape_info.data(), stride_info.data());
   }
 
   template<typename T>
   void set(int ndim, const T* shape, const T* stride, cnnlDataType_t data_type,
            cnnlTensorLayout_t layout = CNNL_LAYOUT_ARRAY) {
     if (!ndim) {
-      ndim = 1;
-      std::vector<int> shape_info(1, 1);
-      OF_CNNL_CHECK(cnnlSetTensorDescriptorEx(this->mut_desc(), CNNL_LAYOUT_ARRAY, data_type, ndim,
-                                              shape_info.data(), shape_info.data()));
+      SetScalar(data_type);
       return;
     }
-    std::vector<int> shape_info(ndim, 1);
-    std::vector<int> stride_info(ndim, 1);
+    std::vector<int64_t> shape_info(ndim, 1);
+    std::vector<int64_t> stride_info(ndim, 1);
     for (int i = 0; i < ndim; ++i) {
-      shape_info[i] = static_cast<int>(shape[i]);
-      stride_info[i] = static_cast<int>(stride[i]);
+      shape_info[i] = static_cast<int64_t>(shape[i]);
+      stride_info[i] = static_cast<int64_t>(stride[i]);
     }
-    OF_CNNL_CHECK(cnnlSetTensorDescriptorEx(this->mut_desc(), layout, data_type, ndim,
-                                            shape_info.data(), stride_info.data()));
+    SetShapeAndStride(layout, data_type, ndim, shape_info.data(), stride_info.data());
   }
+
+ private:
+  void SetScalar(cnnlDataType_t data_type);
+  // Uses the int64 descriptor API when available, otherwise narrows to int and throws if any
+  // dim or stride does not fit.
+  void SetShapeAndStride(cnnlTensorLayout_t layout, cnnlDataType_t data_type, int ndim,
+                         const int64_t* shape, const int64_t* stride);
+  void SetShape(cnnlTensorLayout_t layout, cnnlDataType_t data_type, int ndim,
+                const int64_t* shape);
+  bool IsSameShapeAndStride(cnnlTensorLayout_t layout, cnnlDataType_t data_type, int ndim,
+                            const int64_t* shape, const int64_t* stride) const;
+
+  // last shape and stride passed to CNNL, resetting the same values is skipped. Any other
+  // setter invalidates it since CNNL may reset its fields along with the shape.
+  static constexpr int kMaxCachedNumDims = 8;
+  int cached_ndim_ = -1;
+  cnnlTensorLayout_t cached_layout_ = CNNL_LAYOUT_ARRAY;
+  cnnlDataType_t cached_data_type_ = CNNL_DTYPE_INVALID;
+  int64_t cached_shape_[kMaxCachedNumDims];
+  int64_t cached_stride_[kMaxCachedNumDims];
 };
 
 class CnnlSeqDataDescriptor : public CnnlDescriptor<cnnlSeqDataStruct, &cnnlCreateSeqDataDescriptor,
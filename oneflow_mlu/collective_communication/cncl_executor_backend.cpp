@@ -26,7 +26,12 @@ limitations under the License.
 #include "oneflow/core/thread/thread_pool.h"
 #include "oneflow_mlu/common/mlu_util.h"
 #include "oneflow_mlu/common/mlu_guard.h"
+#include "oneflow_mlu/ep/mlu_completion_poller.h"
+#include "oneflow_mlu/ep/mlu_device.h"
+#include "oneflow/core/ep/include/device_manager_registry.h"
 
+#include <future>
+#include <map>
 #include <memory>
 #include <utility>
 
@@ -52,6 +57,13 @@ std::string GetCnclUniqueIdRpcKey(const std::string& name, int64_t stream_id) {
   return "CollectiveBoxingExecutorCnclUniqueIdRpcKey-" + name + "-" + std::to_string(stream_id);
 }
 
+// Key of all clique ids a process owns in one job, pulled once by every process sharing a group
+// with it instead of once per group and stream.
+std::string GetCnclUniqueIdBatchRpcKey(int64_t job_id, int64_t owner_machine_id) {
+  return "CollectiveBoxingExecutorCnclUniqueIdBatchRpcKey-" + std::to_string(job_id) + "-"
+         + std::to_string(owner_machine_id);
+}
+
 struct CopyParams {
   void* dst;
   const void* src;
@@ -117,6 +129,7 @@ class CommRank final {
   }
 
   int32_t device_id() const { return device_id_; }
+  int32_t global_rank() const { return global_rank_; }
 
   cnclComm_t cncl_comm() const { return cncl_comm_; }
 
@@ -142,11 +155,13 @@ class CommGroup final {
   ~CommGroup() = default;
   CommGroup(CommGroup&& rhs) noexcept {
     rank_vec_.swap(rhs.rank_vec_);
+    init_futures_.swap(rhs.init_futures_);
     global_rank_count_ = rhs.global_rank_count_;
   }
 
-  void InitGroup(const DeviceSet& device_set, const std::string& unique_name) {
-    MluCurrentDeviceGuard guard;
+  // Creates the ranks of this process, their communicators are initialized by InitRanksAsync
+  // once the clique id is known.
+  void InitGroup(const DeviceSet& device_set) {
     const int64_t this_machine_id = GlobalProcessCtx::Rank();
     global_rank_count_ = device_set.device_size();
     std::vector<int32_t> local_ranks;
@@ -155,28 +170,39 @@ class CommGroup final {
     }
     const int32_t local_rank_count = local_ranks.size();
     CHECK_GT(local_rank_count, 0);
-    cnclCliqueId cncl_clique_id{};
-    if (local_ranks.front() == 0) {
-      OF_CNCL_CHECK(cnclGetCliqueId(&cncl_clique_id));
-      if (local_rank_count != global_rank_count_) {
-        Singleton<CtrlClient>::Get()->PushKV(unique_name, CnclCliqueIdToString(cncl_clique_id));
-      }
-    } else {
-      Singleton<CtrlClient>::Get()->PullKV(unique_name, [&cncl_clique_id](const std::string& val) {
-        CnclCliqueIdFromString(val, &cncl_clique_id);
-      });
-    }
     rank_vec_.reserve(local_rank_count);
     for (int32_t local_rank = 0; local_rank < local_ranks.size(); ++local_rank) {
       const int32_t global_rank = local_ranks.at(local_rank);
       const int32_t device_id = device_set.device(global_rank).device_id();
-      MluCurrentDeviceGuard guard(device_id);
       rank_vec_.emplace_back(device_id, global_rank, global_rank_count_, local_rank,
                              local_rank_count);
-      rank_vec_.at(local_rank).InitRank(cncl_clique_id, global_rank_count_);
     }
   }
 
+  // Queues the cnclInitComms of every local rank on pool. The local ranks of a clique have to join
+  // it concurrently, so pool needs a thread per local device. Every process queues the groups of
+  // a job in request order and the pool hands consecutive works to distinct threads, a thread
+  // blocked on a clique therefore only waits for ranks queued ahead of any later clique.
+  void InitRanksAsync(const cnclCliqueId& clique_id, ThreadPool* pool) {
+    for (CommRank& comm_rank : rank_vec_) {
+      CommRank* rank = &comm_rank;
+      const int32_t global_rank_count = global_rank_count_;
+      auto init_rank = std::make_shared<std::packaged_task<void()>>(
+          [rank, clique_id, global_rank_count]() { rank->InitRank(clique_id, global_rank_count); });
+      init_futures_.emplace_back(init_rank->get_future().share());
+      pool->AddWork([init_rank]() { (*init_rank)(); });
+    }
+  }
+
+  // Blocks until the communicators of this group are ready, other groups are not waited for.
+  void WaitReady() const {
+    for (const auto& future : init_futures_) { future.wait(); }
+  }
+
+  bool owns_clique_id() const { return rank_vec_.front().global_rank() == 0; }
+
+  bool is_local() const { return rank_vec_.size() == global_rank_count_; }
+
   int32_t global_rank_count() const { return global_rank_count_; }
 
   int32_t local_rank_count() const { return rank_vec_.size(); }
@@ -185,6 +211,7 @@ class CommGroup final {
 
  private:
   std::vector<CommRank> rank_vec_;
+  std::vector<std::shared_future<void>> init_futures_;
   int32_t global_rank_count_ = 0;
 };
 
@@ -200,36 +227,21 @@ class StreamCtx {
     OF_MLU_CHECK(cnrtQueueCreateWithPriority(&stream_, 0, greatest_priority));
     void* data_ptr = (void*)fusion_buffer_;
     OF_MLU_CHECK(cnrtMalloc(&data_ptr, fusion_buffer_size_));
-    cb_event_poller_ = std::thread(&StreamCtx::PollEvent, this);
+    device_ = std::dynamic_pointer_cast<ep::MluDevice>(
+        Singleton<ep::DeviceManagerRegistry>::Get()->GetDevice(DeviceType::kMLU, device_id_));
+    CHECK(device_);
+    callback_queue_.reset(new ep::MluCallbackQueue(device_.get(), stream_));
   }
   ~StreamCtx() {
-    cb_event_chan_.Close();
-    cb_event_poller_.join();
+    callback_queue_.reset();
     MluCurrentDeviceGuard guard(device_id_);
     OF_MLU_CHECK(cnrtQueueSync(stream_));
     OF_MLU_CHECK(cnrtQueueDestroy(stream_));
     OF_MLU_CHECK(cnrtFree(fusion_buffer_));
   }
 
-  void PollEvent() {
-    MluCurrentDeviceGuard guard(device_id_);
-    while (true) {
-      std::pair<cnrtNotifier_t, std::function<void()>> cb_event;
-      ChannelStatus status = cb_event_chan_.Receive(&cb_event);
-      if (status == kChannelStatusErrorClosed) { break; }
-      CHECK_EQ(status, kChannelStatusSuccess);
-      OF_MLU_CHECK(cnrtWaitNotifier(cb_event.first));
-      cb_event.second();
-      OF_MLU_CHECK(cnrtNotifierDestroy(cb_event.first));
-    }
-  }
-
-  void AddCallback(const std::function<void()>& callback) {
-    MluCurrentDeviceGuard guard(device_id_);
-    cnrtNotifier_t event;
-    OF_MLU_CHECK(cnrtNotifierCreateWithFlags(&event, CNRT_NOTIFIER_DEFAULT));
-    OF_MLU_CHECK(cnrtPlaceNotifier(event, stream_));
-    CHECK_EQ(cb_event_chan_.Send(std::make_pair(event, callback)), kChannelStatusSuccess);
+  void AddCallback(std::function<void()> callback) {
+    callback_queue_->AddCallback(std::move(callback));
   }
 
   int32_t device_id() const { return device_id_; }
@@ -245,8 +257,8 @@ class StreamCtx {
   cnrtQueue_t stream_ = nullptr;
   size_t fusion_buffer_size_;
   char* fusion_buffer_ = nullptr;
-  Channel<std::pair<cnrtNotifier_t, std::function<void()>>> cb_event_chan_;
-  std::thread cb_event_poller_;
+  std::shared_ptr<ep::MluDevice> device_;
+  std::unique_ptr<ep::MluCallbackQueue> callback_queue_;
 };
 
 void LaunchFusedAllReduce(const CommGroup& comm_group,
@@ -355,28 +367,18 @@ void LaunchAggregatedOps(const CommGroup& comm_group,
         const int64_t elem_per_chunk = elem_per_rank / num_ranks;
         const int64_t dtype_size = GetSizeOfDataType(op_desc.data_type());
         const int64_t chunk_size = elem_per_chunk * dtype_size;
-        int64_t current_rank = GlobalProcessCtx::Rank();
+        const int64_t current_rank = comm_rank.global_rank();
         OF_MLU_CHECK(cnrtMemcpyAsync(
             reinterpret_cast<void*>(reinterpret_cast<char*>(recv_buff) + current_rank * chunk_size),
             const_cast<void*>(reinterpret_cast<const void*>(reinterpret_cast<const char*>(send_buff)
                                                             + current_rank * chunk_size)),
             chunk_size, stream_ctx->stream(), cnrtMemcpyDevToDev));
-        for (int64_t j = 0; j < current_rank; ++j) {
-          OF_CNCL_CHECK(
-              cnclRecv(reinterpret_cast<void*>(reinterpret_cast<char*>(recv_buff) + j * chunk_size),
-                       elem_per_chunk, cncl_data_type, j, comm, stream_ctx->stream()));
-        }
-        for (int64_t j = current_rank + 1; j < num_ranks; ++j) {
+        CnclGroupGuard group;
+        for (int64_t j = 0; j < num_ranks; ++j) {
+          if (j == current_rank) { continue; }
           OF_CNCL_CHECK(cnclSend(const_cast<void*>(reinterpret_cast<const void*>(
                                      reinterpret_cast<const char*>(send_buff) + j * chunk_size)),
                                  elem_per_chunk, cncl_data_type, j, comm, stream_ctx->stream()));
-        }
-        for (int64_t j = 0; j < current_rank; ++j) {
-          OF_CNCL_CHECK(cnclSend(const_cast<void*>(reinterpret_cast<const void*>(
-                                     reinterpret_cast<const char*>(send_buff) + j * chunk_size)),
-                                 elem_per_chunk, cncl_data_type, j, comm, stream_ctx->stream()));
-        }
-        for (int64_t j = current_rank + 1; j < num_ranks; ++j) {
           OF_CNCL_CHECK(
               cnclRecv(reinterpret_cast<void*>(reinterpret_cast<char*>(recv_buff) + j * chunk_size),
                        elem_per_chunk, cncl_data_type, j, comm, stream_ctx->stream()));
@@ -452,14 +454,20 @@ struct CnclExecutorBackend::Impl {
         (!conf.nccl_fusion_all_reduce_use_buffer()) && conf.nccl_enable_mixed_fusion();
     InitStreamCtx();
     InitIsOpTypeFusionEnabled();
+    comm_init_pool = std::make_unique<ThreadPool>(stream_id2device_id2stream_ctx.front().size());
   }
   ~Impl() {
+    // Joins the pending cnclInitComms before the ranks they write are destroyed.
+    comm_init_pool.reset();
     stream_id2device_id2stream_ctx.clear();
     device_set2stream_id2comm_group.clear();
   }
 
   void InitCommGroup(int64_t job_id) {
     std::set<int64_t> local_device_ids;
+    // (rpc name, group) of every new group of this job, the name is the one of its first request
+    std::vector<std::pair<std::string, CommGroup*>> new_groups;
+    std::set<int64_t> owner_machine_ids;
     request_store->ForEachMutRequestEntryInJob(
         job_id, [&](RequestEntry* request_entry, int32_t i, const RequestId& request_id) {
           const auto& request = request_entry->desc();
@@ -470,13 +478,45 @@ struct CnclExecutorBackend::Impl {
           auto& stream_id2comm_group = device_set2stream_id2comm_group[device_set];
           stream_id2comm_group.resize(num_streams);
           for (int32_t stream_id = 0; stream_id < num_streams; ++stream_id) {
-            stream_id2comm_group.at(stream_id).InitGroup(
-                device_set, GetCnclUniqueIdRpcKey(request.op_desc().name(), stream_id));
+            stream_id2comm_group.at(stream_id).InitGroup(device_set);
+            new_groups.emplace_back(GetCnclUniqueIdRpcKey(request.op_desc().name(), stream_id),
+                                    &stream_id2comm_group.at(stream_id));
           }
           for (int32_t j = 0; j < stream_id2comm_group.at(0).local_rank_count(); ++j) {
             local_device_ids.emplace(stream_id2comm_group.at(0).GetCommRank(j).device_id());
           }
+          const int64_t owner_machine_id = device_set.device(0).machine_id();
+          if (owner_machine_id != GlobalProcessCtx::Rank()) {
+            owner_machine_ids.emplace(owner_machine_id);
+          }
         });
+
+    // Clique ids go through the ctrl server in one batch per owning process.
+    std::map<std::string, cnclCliqueId> name2clique_id;
+    std::map<std::string, cnclCliqueId> owned_name2clique_id;
+    for (const auto& pair : new_groups) {
+      if (pair.second->owns_clique_id()) {
+        cnclCliqueId clique_id{};
+        OF_CNCL_CHECK(cnclGetCliqueId(&clique_id));
+        name2clique_id[pair.first] = clique_id;
+        if (!pair.second->is_local()) { owned_name2clique_id[pair.first] = clique_id; }
+      }
+    }
+    if (!owned_name2clique_id.empty()) {
+      Singleton<CtrlClient>::Get()->PushKV(
+          GetCnclUniqueIdBatchRpcKey(job_id, GlobalProcessCtx::Rank()),
+          CnclCliqueIdsToString(owned_name2clique_id));
+    }
+    for (const int64_t owner_machine_id : owner_machine_ids) {
+      Singleton<CtrlClient>::Get()->PullKV(GetCnclUniqueIdBatchRpcKey(job_id, owner_machine_id),
+                                           [&name2clique_id](const std::string& val) {
+                                             CnclCliqueIdsFromString(val, &name2clique_id);
+                                           });
+    }
+    for (const auto& pair : new_groups) {
+      pair.second->InitRanksAsync(name2clique_id.at(pair.first), comm_init_pool.get());
+    }
+
     for (int32_t stream_id = 0; stream_id < num_streams; ++stream_id) {
       for (const int64_t device_id : local_device_ids) {
         if (stream_id2device_id2stream_ctx.at(stream_id).at(device_id) == nullptr) {
@@ -607,6 +647,7 @@ struct CnclExecutorBackend::Impl {
     if (request_ids.empty()) { return; }
     const int32_t stream_id = NextStreamId();
     const auto& comm_group = token->stream_id2comm_group->at(stream_id);
+    comm_group.WaitReady();
     auto& device_id2stream_ctx = stream_id2device_id2stream_ctx.at(stream_id);
     if (request_store->MutRequestEntry(request_ids.front())->desc().op_desc().op_type()
             == OpType::kOpTypeAllReduce
@@ -627,6 +668,7 @@ struct CnclExecutorBackend::Impl {
   std::shared_ptr<RequestStore> request_store;
   HashMap<DeviceSet, std::vector<CommGroup>> device_set2stream_id2comm_group;
   std::vector<std::vector<std::unique_ptr<StreamCtx>>> stream_id2device_id2stream_ctx;
+  std::unique_ptr<ThreadPool> comm_init_pool;
 };
 
 CnclExecutorBackend::CnclExecutorBackend() = default;
@@ -30,4 +30,29 @@ void CnclCliqueIdFromString(const std::string& str, cnclCliqueId* unique_id) {
   memcpy(&unique_id->hash, str.data() + CNCL_CLIQUE_ID_BYTES_SIZE, sizeof(uint64_t));
 }
 
+// Entries are "<name size>:<name><clique id>", clique ids have a fixed size.
+std::string CnclCliqueIdsToString(const std::map<std::string, cnclCliqueId>& name2unique_id) {
+  std::string result;
+  for (const auto& pair : name2unique_id) {
+    result += std::to_string(pair.first.size()) + ":" + pair.first
+              + CnclCliqueIdToString(pair.second);
+  }
+  return result;
+}
+
+void CnclCliqueIdsFromString(const std::string& str,
+                             std::map<std::string, cnclCliqueId>* name2unique_id) {
+  const size_t id_size = CNCL_CLIQUE_ID_BYTES_SIZE + sizeof(uint64_t);
+  size_t pos = 0;
+  while (pos < str.size()) {
+    const size_t colon = str.find(':', pos);
+    CHECK_NE(colon, std::string::npos);
+    const size_t name_size = std::stoull(str.substr(pos, colon - pos));
+    CHECK_LE(colon + 1 + name_size + id_size, str.size());
+    const std::string name = str.substr(colon + 1, name_size);
+    CnclCliqueIdFromString(str.substr(colon + 1 + name_size, id_size), &(*name2unique_id)[name]);
+    pos = colon + 1 + name_size + id_size;
+  }
+}
+
 }  // namespace oneflow
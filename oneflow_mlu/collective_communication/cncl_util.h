@@ -17,6 +17,7 @@ limitations under the License.
 #define ONEFLOW_CAMBRICON_COLLECTIVE_COMMUNICATION_CNCL_UTIL_H_
 
 #include <glog/logging.h>
+#include <map>
 #include "oneflow/core/common/util.h"
 #include "oneflow/core/common/data_type.pb.h"
 
@@ -56,10 +57,25 @@ inline cnclDataType_t GetCnclDataType(const DataType& dt) {
   return cnclFloat;
 }
 
+// cnclSend and cnclRecv calls issued by this thread while the guard is alive are posted as one
+// group, transfers with several peers then progress together and their order does not matter.
+class CnclGroupGuard final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(CnclGroupGuard);
+  CnclGroupGuard() { OF_CNCL_CHECK(cnclGroupStart()); }
+  ~CnclGroupGuard() { OF_CNCL_CHECK(cnclGroupEnd()); }
+};
+
 std::string CnclCliqueIdToString(const cnclCliqueId& unique_id);
 
 void CnclCliqueIdFromString(const std::string& str, cnclCliqueId* unique_id);
 
+// Packs many named clique ids into one ctrl KV value.
+std::string CnclCliqueIdsToString(const std::map<std::string, cnclCliqueId>& name2unique_id);
+
+void CnclCliqueIdsFromString(const std::string& str,
+                             std::map<std::string, cnclCliqueId>* name2unique_id);
+
 }  // namespace oneflow
 
 #endif  // ONEFLOW_CAMBRICON_COLLECTIVE_COMMUNICATION_CNCL_UTIL_H_
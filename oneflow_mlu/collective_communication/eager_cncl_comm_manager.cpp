@@ -13,9 +13,12 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 */
+#include <algorithm>
 #include <iomanip>
+#include <set>
 #include <string>
 #include "oneflow/core/rpc/include/base.h"
+#include "oneflow/core/common/blocking_counter.h"
 #include "oneflow/core/control/ctrl_client.h"
 #include "oneflow/core/control/global_process_ctx.h"
 #include "oneflow/core/job/env_global_objects_scope.h"
@@ -24,6 +27,7 @@ limitations under the License.
 #include "oneflow/core/job/parallel_desc.h"
 #include "oneflow/core/operator/op_conf.pb.h"
 #include "oneflow/core/vm/vm_util.h"
+#include "oneflow/core/thread/thread_pool.h"
 #include "oneflow_mlu/common/mlu_util.h"
 #include "oneflow_mlu/common/mlu_guard.h"
 #include "oneflow/core/graph/boxing/collective_boxing.pb.h"
@@ -34,6 +38,7 @@ namespace oneflow {
 namespace {
 
 static const int64_t kNumOfCommInCurProcess = 1;
+static const int64_t kMaxNumOfConcurrentCommInits = 8;
 
 std::string GetcnclCliqueIdRpcKey(const std::vector<std::pair<int64_t, int64_t>>& sorted_devices) {
   std::ostringstream oss;
@@ -60,22 +65,17 @@ bool CompareDeviceSetPair(const std::pair<int64_t, int64_t>& a,
   }
 }
 
-void CreateCnclComm(cnclComm_t* comm, const int dev, const std::string& key,
-                    const std::vector<std::pair<int64_t, int64_t>>& device_vec) {
-  cnclCliqueId cncl_unique_id{};
-  int64_t machine = GlobalProcessCtx::Rank();
-  std::pair<int64_t, int64_t> this_device(machine, dev);
+int GetRankInDeviceVec(const int dev, const std::vector<std::pair<int64_t, int64_t>>& device_vec) {
+  std::pair<int64_t, int64_t> this_device(GlobalProcessCtx::Rank(), dev);
   auto it = std::find(device_vec.cbegin(), device_vec.cend(), this_device);
   CHECK(it != device_vec.end());
-  int rank = std::distance(device_vec.cbegin(), it);
-  if (rank == 0) {
-    OF_CNCL_CHECK(cnclGetCliqueId(&cncl_unique_id));
-    Singleton<::oneflow::CtrlClient>::Get()->PushKV(key, CnclCliqueIdToString(cncl_unique_id));
-  } else {
-    Singleton<::oneflow::CtrlClient>::Get()->PullKV(key, [&cncl_unique_id](const std::string& val) {
-      CnclCliqueIdFromString(val, &cncl_unique_id);
-    });
-  }
+  return std::distance(device_vec.cbegin(), it);
+}
+
+void InitCnclComm(cnclComm_t* comm, const int dev, const std::string& key,
+                  const std::vector<std::pair<int64_t, int64_t>>& device_vec,
+                  cnclCliqueId cncl_unique_id) {
+  int rank = GetRankInDeviceVec(dev, device_vec);
   int32_t dev_list[kNumOfCommInCurProcess] = {dev};
   int32_t rank_list[kNumOfCommInCurProcess] = {rank};
   VLOG(2) << " EagerCnclCommMgr::cnclCommInitRank device_vec.size() = " << device_vec.size()
@@ -88,6 +88,39 @@ void CreateCnclComm(cnclComm_t* comm, const int dev, const std::string& key,
           << ", key = {" << key << "}\n";
 }
 
+void CreateCnclComm(cnclComm_t* comm, const int dev, const std::string& key,
+                    const std::vector<std::pair<int64_t, int64_t>>& device_vec) {
+  cnclCliqueId cncl_unique_id{};
+  if (GetRankInDeviceVec(dev, device_vec) == 0) {
+    OF_CNCL_CHECK(cnclGetCliqueId(&cncl_unique_id));
+    Singleton<::oneflow::CtrlClient>::Get()->PushKV(key, CnclCliqueIdToString(cncl_unique_id));
+  } else {
+    Singleton<::oneflow::CtrlClient>::Get()->PullKV(key, [&cncl_unique_id](const std::string& val) {
+      CnclCliqueIdFromString(val, &cncl_unique_id);
+    });
+  }
+  InitCnclComm(comm, dev, key, device_vec, cncl_unique_id);
+}
+
+std::string GetCliqueIdBatchRpcKey(int64_t job_id, int64_t owner_process_id) {
+  return "eager_cncl_unique_id_batch_rpc_key-" + std::to_string(job_id) + "-"
+         + std::to_string(owner_process_id);
+}
+
+// Pushed by a process once the communicator of key is recorded in device_set2device_id2comm_.
+// GetCommForDevice is the only writer of that cache and pushes this key after every insert,
+// GetCommAndPeerRankForPeer blocks on it without a timeout, so any new writer must push it too.
+std::string GetCommRecordedRpcKey(const std::string& key, int64_t process_id) {
+  return key + "-recorded:" + std::to_string(process_id);
+}
+
+std::string GetPeerCommRpcKey(int64_t process_id, int64_t peer_process_id) {
+  std::ostringstream oss;
+  oss << "eager_cncl_p2p_comm_rpc_key," << std::min(process_id, peer_process_id) << ","
+      << std::max(process_id, peer_process_id);
+  return oss.str();
+}
+
 bool NeedUnifiedCnclCommInit(const OperatorConf& op_conf) {
   if (op_conf.has_user_conf()) {
     return UserKernelUnifiedCnclCommInitRegistry::Instance().IsRegistered(
@@ -134,9 +167,94 @@ cnclComm_t EagerCnclCommMgr::GetCommForDevice(
     std::lock_guard<std::mutex> lock(mutex_);
     device_set2device_id2comm_[device_set][dev] = comm;
   }
+  Singleton<::oneflow::CtrlClient>::Get()->PushKV(
+      GetCommRecordedRpcKey(cncl_unique_id_rpc_key, GlobalProcessCtx::Rank()), "");
   return comm;
 }
 
+std::pair<cnclComm_t, int64_t> EagerCnclCommMgr::GetCommAndPeerRankForPeer(
+    int64_t peer_process_id) {
+  const int64_t rank = GlobalProcessCtx::Rank();
+  const std::pair<int64_t, int64_t> this_device(rank, GlobalProcessCtx::LocalRank());
+  const std::pair<int64_t, int64_t> peer_device(peer_process_id,
+                                                GlobalProcessCtx::LocalRank(peer_process_id));
+  int dev;
+  CNRT_CHECK(cnrtGetDevice(&dev));
+  auto ContainsBothDevices = [&](const std::set<std::pair<int64_t, int64_t>>& device_set) {
+    return device_set.count(this_device) > 0 && device_set.count(peer_device) > 0;
+  };
+  auto PeerRankIn = [&](const std::set<std::pair<int64_t, int64_t>>& device_set) {
+    std::vector<std::pair<int64_t, int64_t>> device_vec(device_set.cbegin(), device_set.cend());
+    std::sort(device_vec.begin(), device_vec.end(), CompareDeviceSetPair);
+    return std::distance(device_vec.cbegin(),
+                         std::find(device_vec.cbegin(), device_vec.cend(), peer_device));
+  };
+
+  // Both processes have to agree on the communicator. The lower process picks the smallest eager
+  // group holding both devices and publishes its key, an empty key asks for a two rank
+  // communicator.
+  const std::string rpc_key = GetPeerCommRpcKey(rank, peer_process_id);
+  std::string group_key;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = peer_process_id2comm_and_peer_rank_.find(peer_process_id);
+    if (it != peer_process_id2comm_and_peer_rank_.end()) { return it->second; }
+    if (rank < peer_process_id) {
+      const std::set<std::pair<int64_t, int64_t>>* group = nullptr;
+      for (const auto& pair : device_set2device_id2comm_) {
+        if (!ContainsBothDevices(pair.first) || pair.second.count(dev) == 0) { continue; }
+        if (group == nullptr || pair.first.size() < group->size()) { group = &pair.first; }
+      }
+      if (group != nullptr) {
+        std::vector<std::pair<int64_t, int64_t>> device_vec(group->cbegin(), group->cend());
+        std::sort(device_vec.begin(), device_vec.end(), CompareDeviceSetPair);
+        group_key = GetcnclCliqueIdRpcKey(device_vec);
+        peer_process_id2comm_and_peer_rank_[peer_process_id] =
+            std::make_pair(device_set2device_id2comm_.at(*group).at(dev), PeerRankIn(*group));
+      }
+    }
+  }
+  if (rank < peer_process_id) {
+    Singleton<::oneflow::CtrlClient>::Get()->PushKV(rpc_key, group_key);
+  } else {
+    Singleton<::oneflow::CtrlClient>::Get()->PullKV(
+        rpc_key, [&group_key](const std::string& val) { group_key = val; });
+  }
+
+  if (group_key.empty()) {
+    std::set<std::pair<int64_t, int64_t>> device_set{this_device, peer_device};
+    std::pair<cnclComm_t, int64_t> comm_and_peer_rank(GetCommForDevice(device_set),
+                                                      PeerRankIn(device_set));
+    std::lock_guard<std::mutex> lock(mutex_);
+    peer_process_id2comm_and_peer_rank_[peer_process_id] = comm_and_peer_rank;
+    return comm_and_peer_rank;
+  }
+
+  // The group is only missing here while another thread of this process is still creating it in
+  // GetCommForDevice, wait for the key it pushes once the comm is recorded.
+  Singleton<::oneflow::CtrlClient>::Get()->PullKV(GetCommRecordedRpcKey(group_key, rank),
+                                                  [](const std::string&) {});
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto cached_it = peer_process_id2comm_and_peer_rank_.find(peer_process_id);
+  if (cached_it != peer_process_id2comm_and_peer_rank_.end()) { return cached_it->second; }
+  auto IsGroup = [&](const auto& pair) {
+    if (!ContainsBothDevices(pair.first) || pair.second.count(dev) == 0) { return false; }
+    std::vector<std::pair<int64_t, int64_t>> device_vec(pair.first.cbegin(), pair.first.cend());
+    std::sort(device_vec.begin(), device_vec.end(), CompareDeviceSetPair);
+    return GetcnclCliqueIdRpcKey(device_vec) == group_key;
+  };
+  auto group_it = std::find_if(device_set2device_id2comm_.cbegin(),
+                               device_set2device_id2comm_.cend(), IsGroup);
+  // the recorded key is pushed only after the insert, so the group has to be here
+  CHECK(group_it != device_set2device_id2comm_.cend())
+      << "cncl communicator {" << group_key << "} chosen by process "
+      << std::min(rank, peer_process_id) << " is not recorded in process " << rank;
+  std::pair<cnclComm_t, int64_t> comm_and_peer_rank(group_it->second.at(dev),
+                                                    PeerRankIn(group_it->first));
+  peer_process_id2comm_and_peer_rank_[peer_process_id] = comm_and_peer_rank;
+  return comm_and_peer_rank;
+}
+
 cnclComm_t EagerCnclCommMgr::GetCommForDeviceAndStreamName(
     const std::set<std::pair<int64_t, int64_t>>& device_set, const std::string& stream_name) {
   int dev;
@@ -166,8 +284,14 @@ void EagerCnclCommMgr::CreateCommFromPlan(const Plan& plan) {
   const int64_t rank = GlobalProcessCtx::Rank();
   const int64_t dev = GlobalProcessCtx::LocalRank();
   std::map<std::string, std::vector<std::pair<int64_t, int64_t>>> cncl_comm_key2devices;
+  // The smallest job id of the plan is the same on every process, it tells the clique id batches
+  // of this plan apart from those of earlier plans.
+  int64_t plan_job_id = -1;
 
   for (const auto& task_proto : plan.task()) {
+    if (plan_job_id == -1 || task_proto.job_id() < plan_job_id) {
+      plan_job_id = task_proto.job_id();
+    }
     if (task_proto.machine_id() != rank) { continue; }
     if (task_proto.exec_sequence().exec_node_size() != 1) { continue; }
     const auto& kernel_conf = task_proto.exec_sequence().exec_node(0).kernel_conf();
@@ -210,16 +334,66 @@ void EagerCnclCommMgr::CreateCommFromPlan(const Plan& plan) {
   CHECK_JUST(vm::CurrentRankSync());
   MluCurrentDeviceGuard guard(dev);
 
+  for (auto it = cncl_comm_key2devices.begin(); it != cncl_comm_key2devices.end();) {
+    auto device_id2comm_it = device7stream2device_id2comm_.find(it->first);
+    if (device_id2comm_it != device7stream2device_id2comm_.end()
+        && device_id2comm_it->second.count(dev) > 0) {
+      it = cncl_comm_key2devices.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  if (cncl_comm_key2devices.empty()) { return; }
+
+  // The first device of a comm owns its clique id. The owner publishes all ids it owns as one
+  // value under a single key of the plan, a process then pulls once per owner instead of once per
+  // comm.
+  std::map<std::string, cnclCliqueId> key2clique_id;
+  std::map<std::string, cnclCliqueId> owned_key2clique_id;
+  std::set<int64_t> owner_process_ids;
   for (const auto& pair : cncl_comm_key2devices) {
-    const auto& key = pair.first;
-    auto device_id2comm_it = device7stream2device_id2comm_.find(key);
-    if (device_id2comm_it != device7stream2device_id2comm_.end()) {
-      auto comm_it = device_id2comm_it->second.find(dev);
-      if (comm_it != device_id2comm_it->second.end()) { continue; }
+    if (GetRankInDeviceVec(dev, pair.second) == 0) {
+      cnclCliqueId clique_id{};
+      OF_CNCL_CHECK(cnclGetCliqueId(&clique_id));
+      key2clique_id[pair.first] = clique_id;
+      owned_key2clique_id[pair.first] = clique_id;
+    } else {
+      owner_process_ids.insert(pair.second.front().first);
     }
-    cnclComm_t comm;
-    CreateCnclComm(&comm, dev, key, pair.second);
-    device7stream2device_id2comm_[key][dev] = comm;
+  }
+  if (!owned_key2clique_id.empty()) {
+    Singleton<::oneflow::CtrlClient>::Get()->PushKV(GetCliqueIdBatchRpcKey(plan_job_id, rank),
+                                                      CnclCliqueIdsToString(owned_key2clique_id));
+  }
+  for (int64_t owner_process_id : owner_process_ids) {
+    Singleton<::oneflow::CtrlClient>::Get()->PullKV(
+        GetCliqueIdBatchRpcKey(plan_job_id, owner_process_id),
+        [&key2clique_id](const std::string& val) { CnclCliqueIdsFromString(val, &key2clique_id); });
+  }
+
+  // cnclInitComms blocks until every rank joined. Each comm has a single rank in this process and
+  // every process queues its comms in the same key order, so the comms a pool thread blocks on
+  // are joined by the other processes without waiting for a later comm, and a bounded pool is
+  // enough to overlap the inits.
+  std::vector<std::pair<const std::string*, cnclComm_t>> key7comms;
+  key7comms.reserve(cncl_comm_key2devices.size());
+  for (const auto& pair : cncl_comm_key2devices) { key7comms.emplace_back(&pair.first, nullptr); }
+  ThreadPool pool(std::min<int64_t>(key7comms.size(), kMaxNumOfConcurrentCommInits));
+  BlockingCounter counter(key7comms.size());
+  for (auto& key7comm : key7comms) {
+    const std::string& key = *key7comm.first;
+    cnclComm_t* comm = &key7comm.second;
+    const auto& device_vec = cncl_comm_key2devices.at(key);
+    const cnclCliqueId clique_id = key2clique_id.at(key);
+    pool.AddWork([comm, dev, &key, &device_vec, clique_id, &counter]() {
+      MluCurrentDeviceGuard guard(dev);
+      InitCnclComm(comm, dev, key, device_vec, clique_id);
+      counter.Decrease();
+    });
+  }
+  counter.WaitForeverUntilCntEqualZero();
+  for (const auto& key7comm : key7comms) {
+    device7stream2device_id2comm_[*key7comm.first][dev] = key7comm.second;
   }
 }
 
@@ -36,6 +36,10 @@ class EagerCnclCommMgr final : public EagerCclCommMgr {
   cnclComm_t GetCommForDevice(const std::set<std::pair<int64_t, int64_t>>& device_set);
   cnclComm_t GetCommForDeviceAndStreamName(const std::set<std::pair<int64_t, int64_t>>& device_set,
                                            const std::string& stream_name);
+  // Communicator for point-to-point with peer_process_id and the cncl rank of the peer in it. An
+  // eager group communicator that already holds both devices is reused, a two rank communicator
+  // is only created when there is none.
+  std::pair<cnclComm_t, int64_t> GetCommAndPeerRankForPeer(int64_t peer_process_id);
 
   void CreateCommFromPlan(const Plan& plan) override;
   bool IsAsyncLaunchCclLogicalKernel() const override { return async_launch_cncl_logical_kernel_; }
@@ -44,9 +48,12 @@ class EagerCnclCommMgr final : public EagerCclCommMgr {
   }
 
  private:
+  // Only GetCommForDevice inserts here, it announces every insert to the other processes through
+  // the recorded rpc key that GetCommAndPeerRankForPeer waits on.
   std::map<std::set<std::pair<int64_t, int64_t>>, HashMap<int64_t, cnclComm_t>>
       device_set2device_id2comm_;
   std::map<std::string, HashMap<int64_t, cnclComm_t>> device7stream2device_id2comm_;
+  HashMap<int64_t, std::pair<cnclComm_t, int64_t>> peer_process_id2comm_and_peer_rank_;
   std::mutex mutex_;
   bool async_launch_cncl_logical_kernel_;
 };
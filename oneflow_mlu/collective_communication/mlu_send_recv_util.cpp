@@ -23,15 +23,9 @@ namespace oneflow {
 namespace ccl {
 
 std::pair<cnclComm_t, int64_t> RawGetCnclCommAndPeerCnclRank(int64_t peer_process_id) {
-  std::set<std::pair<int64_t, int64_t>> device_set;
-  const int64_t& rank = GlobalProcessCtx::Rank();
-  const int64_t peer_cncl_rank = (peer_process_id > rank) ? 1 : 0;
-  device_set.emplace(rank, GlobalProcessCtx::LocalRank());
-  device_set.emplace(peer_process_id, GlobalProcessCtx::LocalRank(peer_process_id));
-  return {CHECK_NOTNULL(Singleton<EagerCclCommMgr>::Get())
-              ->As<EagerCnclCommMgr>()
-              ->GetCommForDevice(device_set),
-          peer_cncl_rank};
+  return CHECK_NOTNULL(Singleton<EagerCclCommMgr>::Get())
+      ->As<EagerCnclCommMgr>()
+      ->GetCommAndPeerRankForPeer(peer_process_id);
 }
 
 decltype(GetCnclCommAndPeerCnclRank) GetCnclCommAndPeerCnclRank =
@@ -0,0 +1,177 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow_mlu/ep/mlu_completion_poller.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "oneflow_mlu/common/mlu_guard.h"
+#include "oneflow_mlu/ep/mlu_device.h"
+#include "oneflow_mlu/ep/mlu_event.h"
+#include "oneflow/core/profiler/profiler.h"
+
+namespace oneflow {
+namespace ep {
+
+namespace {
+
+// The poller spins while callbacks keep completing and backs off exponentially up to this
+// interval while the oldest notifiers are still in flight.
+constexpr int64_t kMaxPollIntervalUs = 128;
+
+}  // namespace
+
+class MluCompletionPoller final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(MluCompletionPoller);
+
+  static MluCompletionPoller* Get() {
+    // Never destroyed: stream contexts may still drain their callbacks during static destruction.
+    static MluCompletionPoller* poller = new MluCompletionPoller();
+    return poller;
+  }
+
+  void Add(MluCallbackQueue* owner, MluEvent* event, std::function<void()> callback) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      incoming_.push_back(Pending{owner, event, std::move(callback)});
+    }
+    cond_.notify_one();
+  }
+
+ private:
+  struct Pending {
+    MluCallbackQueue* owner;
+    MluEvent* event;
+    std::function<void()> callback;
+  };
+
+  MluCompletionPoller() : thread_(&MluCompletionPoller::Poll, this) {}
+  ~MluCompletionPoller() = default;
+
+  void SetDevice(int device_index) {
+    if (device_index != current_device_) {
+      OF_MLU_CHECK(cnrtSetDevice(device_index));
+      current_device_ = device_index;
+    }
+  }
+
+  void Poll() {
+    OF_PROFILER_NAME_THIS_HOST_THREAD("_mlu Poller");
+    std::vector<Pending> pending;
+    std::vector<Pending> ready;
+    std::vector<cnrtQueue_t> blocked_queues;
+    int64_t interval_us = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (pending.empty()) {
+          cond_.wait(lock, [&]() { return !incoming_.empty(); });
+          interval_us = 0;
+        }
+        std::move(incoming_.begin(), incoming_.end(), std::back_inserter(pending));
+        incoming_.clear();
+      }
+      // Notifiers on one queue complete in the order they were placed, so the first unfinished
+      // notifier of a queue means the rest of that queue need not be queried this round.
+      blocked_queues.clear();
+      size_t num_kept = 0;
+      for (size_t i = 0; i < pending.size(); ++i) {
+        Pending& entry = pending[i];
+        const cnrtQueue_t queue = entry.owner->queue();
+        bool done = false;
+        if (std::find(blocked_queues.begin(), blocked_queues.end(), queue)
+            == blocked_queues.end()) {
+          SetDevice(entry.owner->device()->device_index());
+          const cnrtRet_t ret = cnrtQueryNotifier(entry.event->mlu_event());
+          if (ret == cnrtSuccess) {
+            done = true;
+          } else {
+            CHECK_EQ(ret, cnrtErrorNotReady) << "cnrtQueryNotifier failed";
+            blocked_queues.push_back(queue);
+          }
+        }
+        if (done) {
+          ready.push_back(std::move(entry));
+        } else {
+          if (num_kept != i) { pending[num_kept] = std::move(entry); }
+          num_kept += 1;
+        }
+      }
+      pending.resize(num_kept);
+      if (ready.empty()) {
+        interval_us = std::min(std::max<int64_t>(interval_us * 2, 1), kMaxPollIntervalUs);
+        std::this_thread::sleep_for(std::chrono::microseconds(interval_us));
+        continue;
+      }
+      interval_us = 0;
+      for (Pending& entry : ready) {
+        SetDevice(entry.owner->device()->device_index());
+        entry.callback();
+      }
+      // Return the notifiers in runs per device to take each event pool lock once per run.
+      std::vector<Event*> events;
+      for (size_t i = 0; i < ready.size(); ++i) {
+        events.push_back(ready[i].event);
+        MluDevice* device = ready[i].owner->device();
+        if (i + 1 == ready.size() || ready[i + 1].owner->device() != device) {
+          device->DestroyEvents(events.data(), events.size());
+          events.clear();
+        }
+      }
+      for (Pending& entry : ready) { entry.owner->OnCallbackDone(); }
+      ready.clear();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::vector<Pending> incoming_;
+  int current_device_ = -1;
+  std::thread thread_;
+};
+
+MluCallbackQueue::MluCallbackQueue(MluDevice* device, cnrtQueue_t queue)
+    : device_(device), queue_(queue), num_pending_(0) {}
+
+MluCallbackQueue::~MluCallbackQueue() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cond_.wait(lock, [&]() { return num_pending_ == 0; });
+}
+
+void MluCallbackQueue::AddCallback(std::function<void()> callback) {
+  MluCurrentDeviceGuard guard(device_->device_index());
+  Event* event = nullptr;
+  device_->CreateEvents(&event, 1);
+  auto* mlu_event = static_cast<MluEvent*>(event);  // NOLINT
+  OF_MLU_CHECK(cnrtPlaceNotifier(mlu_event->mlu_event(), queue_));
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    num_pending_ += 1;
+  }
+  MluCompletionPoller::Get()->Add(this, mlu_event, std::move(callback));
+}
+
+void MluCallbackQueue::OnCallbackDone() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  num_pending_ -= 1;
+  if (num_pending_ == 0) { cond_.notify_all(); }
+}
+
+}  // namespace ep
+}  // namespace oneflow
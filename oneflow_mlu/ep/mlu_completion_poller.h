@@ -0,0 +1,61 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CAMBRICON_EP_MLU_COMPLETION_POLLER_H_
+#define ONEFLOW_CAMBRICON_EP_MLU_COMPLETION_POLLER_H_
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+#include "oneflow_mlu/common/mlu_util.h"
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+namespace ep {
+
+class MluDevice;
+
+// Host callbacks ordered after the work enqueued on one MLU queue. Callbacks of every
+// MluCallbackQueue in the process are completed by a single shared poller thread, which checks
+// the pending notifiers with cnrtQueryNotifier, runs the ready callbacks in submission order and
+// returns the notifiers to the device's event pool.
+class MluCallbackQueue final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(MluCallbackQueue);
+  MluCallbackQueue(MluDevice* device, cnrtQueue_t queue);
+  // Waits until every callback added to this queue has run.
+  ~MluCallbackQueue();
+
+  void AddCallback(std::function<void()> callback);
+
+  MluDevice* device() const { return device_; }
+  cnrtQueue_t queue() const { return queue_; }
+
+ private:
+  friend class MluCompletionPoller;
+  void OnCallbackDone();
+
+  MluDevice* device_;
+  cnrtQueue_t queue_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  int64_t num_pending_;
+};
+
+}  // namespace ep
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CAMBRICON_EP_MLU_COMPLETION_POLLER_H_
@@ -16,18 +16,20 @@ limitations under the License.
 #ifndef ONEFLOW_CAMBRICON_EP_MLU_RANDOM_GENERATOR_H_
 #define ONEFLOW_CAMBRICON_EP_MLU_RANDOM_GENERATOR_H_
 
-#include <mutex>
+#include <atomic>
 
-#include "oneflow_mlu/common/mlu_util.h"
 #include "oneflow/core/ep/include/random_generator.h"
 
 namespace oneflow {
 namespace ep {
 
+// Philox4x32 generator, the whole state is the seed and the offset of the next stream. Kernels
+// take an offset per launch with get_philox_offset and generate on device from (seed, offset)
+// without any device side state.
 class MLUGenerator : public RandomGenerator {
  public:
   explicit MLUGenerator(uint64_t seed, int device_index);
-  virtual ~MLUGenerator();
+  virtual ~MLUGenerator() = default;
 
   uint64_t current_seed() const override { return seed_; }
   void set_current_seed(uint64_t seed) override;
@@ -39,23 +41,13 @@ class MLUGenerator : public RandomGenerator {
   void GetState(size_t state_size, void* state) const override;
   void SetState(size_t state_size, const void* state) override;
 
-  bool need_update_state() const { return need_update_state_; }
-  void* state() const { return state_; }
-
-  cnnlRandGenerator_t cnnl_rng() const { return cnnl_rng_; }
-
-  void update_state(cnnlHandle_t handle);
-
- public:
-  mutable std::mutex mutex_;
+  // Returns the offset for the next launch and advances it by increment.
+  uint64_t get_philox_offset(uint64_t increment);
 
  private:
-  uint64_t seed_;
+  std::atomic<uint64_t> seed_;
   int64_t device_index_;
-  size_t state_size_;
-  bool need_update_state_;
-  void* state_;
-  cnnlRandGenerator_t cnnl_rng_;
+  std::atomic<uint64_t> philox_offset_;
 };
 
 }  // namespace ep
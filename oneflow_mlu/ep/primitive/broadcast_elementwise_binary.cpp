@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow_mlu/ep/primitive/broadcast_elementwise_binary.h"
+#include "oneflow_mlu/ep/mlu_stream.h"
 #include "oneflow/core/ep/common/primitive/broadcast_elementwise_binary.h"
 #include "oneflow_mlu/ep/primitive/type_seq.h"
 
@@ -24,6 +25,69 @@ namespace mlu {
 
 namespace {
 
+template<typename T, typename D>
+void LaunchBangBroadcastBinaryKernel(Stream* stream, BangBinaryOp op, size_t num_dims,
+                                     const int64_t* dst_dims, const void* src0,
+                                     const int64_t* src0_strides, const void* src1,
+                                     const int64_t* src1_strides, void* dst) {
+  auto* mlu_stream = stream->As<ep::MluStream>();
+  BangHandle handle(mlu_stream->mlu_stream(), mlu_stream->device()->nclusters(),
+                    mlu_stream->device()->ncores_per_cluster());
+  bang_broadcast_binary_kernel<T, D>(handle, op, num_dims, dst_dims, static_cast<const T*>(src0),
+                                     src0_strides, static_cast<const T*>(src1), src1_strides,
+                                     static_cast<D*>(dst));
+}
+
+}  // namespace
+
+void LaunchBangBroadcastBinary(Stream* stream, BangBinaryOp op, DataType src_type,
+                               DataType dst_type, size_t num_src0_dims, const int64_t* src0_dims,
+                               const void* src0, size_t num_src1_dims, const int64_t* src1_dims,
+                               const void* src1, void* dst) {
+  size_t num_dims = std::max(std::max(num_src0_dims, num_src1_dims), static_cast<size_t>(1));
+  CHECK_LE_OR_THROW(num_dims, kBangMaxNumDims);
+  // align both sources to num_dims by prepending 1s, broadcast axes get stride 0
+  int64_t dims[2][kBangMaxNumDims];
+  int64_t strides[2][kBangMaxNumDims];
+  int64_t dst_dims[kBangMaxNumDims];
+  const size_t num_src_dims[2] = {num_src0_dims, num_src1_dims};
+  const int64_t* src_dims[2] = {src0_dims, src1_dims};
+  for (int k = 0; k < 2; ++k) {
+    size_t offset = num_dims - num_src_dims[k];
+    for (size_t i = 0; i < num_dims; ++i) {
+      dims[k][i] = i < offset ? 1 : src_dims[k][i - offset];
+    }
+    int64_t stride = 1;
+    for (int i = num_dims - 1; i >= 0; --i) {
+      strides[k][i] = dims[k][i] == 1 ? 0 : stride;
+      stride *= dims[k][i];
+    }
+  }
+  for (size_t i = 0; i < num_dims; ++i) {
+    dst_dims[i] = std::max(dims[0][i], dims[1][i]);
+    if (dst_dims[i] == 0) { return; }
+  }
+
+  if (src_type == DataType::kInt64 && dst_type == DataType::kInt64) {
+    LaunchBangBroadcastBinaryKernel<int64_t, int64_t>(stream, op, num_dims, dst_dims, src0,
+                                                      strides[0], src1, strides[1], dst);
+  } else if (src_type == DataType::kInt64 && dst_type == DataType::kBool) {
+    LaunchBangBroadcastBinaryKernel<int64_t, bool>(stream, op, num_dims, dst_dims, src0,
+                                                   strides[0], src1, strides[1], dst);
+  } else if (src_type == DataType::kUInt64 && dst_type == DataType::kUInt64) {
+    LaunchBangBroadcastBinaryKernel<uint64_t, uint64_t>(stream, op, num_dims, dst_dims, src0,
+                                                        strides[0], src1, strides[1], dst);
+  } else if (src_type == DataType::kUInt64 && dst_type == DataType::kBool) {
+    LaunchBangBroadcastBinaryKernel<uint64_t, bool>(stream, op, num_dims, dst_dims, src0,
+                                                    strides[0], src1, strides[1], dst);
+  } else {
+    THROW(RuntimeError) << "bang broadcast binary does not support " << DataType_Name(src_type)
+                        << " -> " << DataType_Name(dst_type);
+  }
+}
+
+namespace {
+
 class BroadcastElementwiseBinaryFactoryImpl : public BroadcastElementwiseBinaryFactory {
  public:
   OF_DISALLOW_COPY_AND_MOVE(BroadcastElementwiseBinaryFactoryImpl);
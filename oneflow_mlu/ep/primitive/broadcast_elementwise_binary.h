@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef ONEFLOW_CAMBRICON_EP_PRIMITIVE_BROADCAST_ELEMENTWISE_BINARY_H_
 #define ONEFLOW_CAMBRICON_EP_PRIMITIVE_BROADCAST_ELEMENTWISE_BINARY_H_
 
+#include "oneflow_mlu/bang/bang_kernels.h"
 #include "oneflow/core/ep/include/primitive/broadcast_elementwise_binary.h"
 
 namespace oneflow {
@@ -63,50 +64,53 @@ inline DataType GetBinaryComputeDataType() {
     return GetDataType<D>::value;                     \
   }
 
-GET_BINARY_COMPUTE_DATA_TYPE(BinaryOp::kAdd, int64_t, int32_t);
-GET_BINARY_COMPUTE_DATA_TYPE(BinaryOp::kAdd, uint64_t, int32_t);
-GET_BINARY_COMPUTE_DATA_TYPE(BinaryOp::kSub, int64_t, int32_t);
-GET_BINARY_COMPUTE_DATA_TYPE(BinaryOp::kSub, uint64_t, int32_t);
-GET_BINARY_COMPUTE_DATA_TYPE(BinaryOp::kMul, int64_t, int32_t);
-GET_BINARY_COMPUTE_DATA_TYPE(BinaryOp::kMul, uint64_t, int32_t);
-GET_BINARY_COMPUTE_DATA_TYPE(BinaryOp::kDiv, int64_t, float);
-GET_BINARY_COMPUTE_DATA_TYPE(BinaryOp::kDiv, uint64_t, float);
 GET_BINARY_COMPUTE_DATA_TYPE(BinaryOp::kPow, int32_t, float);
 
-GET_BINARY_COMPUTE_DATA_TYPE(BinaryOp::kEqual, int64_t, int32_t);
-GET_BINARY_COMPUTE_DATA_TYPE(BinaryOp::kEqual, uint64_t, int32_t);
-GET_BINARY_COMPUTE_DATA_TYPE(BinaryOp::kNotEqual, int64_t, int32_t);
-GET_BINARY_COMPUTE_DATA_TYPE(BinaryOp::kNotEqual, uint64_t, int32_t);
-GET_BINARY_COMPUTE_DATA_TYPE(BinaryOp::kGreaterThan, int64_t, int32_t);
-GET_BINARY_COMPUTE_DATA_TYPE(BinaryOp::kGreaterThan, uint64_t, int32_t);
-GET_BINARY_COMPUTE_DATA_TYPE(BinaryOp::kGreaterEqual, int64_t, int32_t);
-GET_BINARY_COMPUTE_DATA_TYPE(BinaryOp::kGreaterEqual, uint64_t, int32_t);
-GET_BINARY_COMPUTE_DATA_TYPE(BinaryOp::kLessThan, int64_t, int32_t);
-GET_BINARY_COMPUTE_DATA_TYPE(BinaryOp::kLessThan, uint64_t, int32_t);
-GET_BINARY_COMPUTE_DATA_TYPE(BinaryOp::kLessEqual, int64_t, int32_t);
-GET_BINARY_COMPUTE_DATA_TYPE(BinaryOp::kLessEqual, uint64_t, int32_t);
-
 #undef GET_BINARY_COMPUTE_DATA_TYPE
 
+// CNNL has no int64 arithmetic and comparison, these ops are computed by the BANG
+// broadcast binary kernel in int64 directly.
+template<BinaryOp op, typename T>
+struct BangBroadcastBinaryTrait {
+  static constexpr bool value = false;
+};
+
+#define SPECIALIZE_BANG_BROADCAST_BINARY_TRAIT(op, T, bang_op) \
+  template<>                                                   \
+  struct BangBroadcastBinaryTrait<op, T> {                     \
+    static constexpr bool value = true;                        \
+    static constexpr BangBinaryOp bang_binary_op = bang_op;    \
+  };
+
+#define SPECIALIZE_BANG_BROADCAST_BINARY_INT64_TRAIT(op, bang_op) \
+  SPECIALIZE_BANG_BROADCAST_BINARY_TRAIT(op, int64_t, bang_op)    \
+  SPECIALIZE_BANG_BROADCAST_BINARY_TRAIT(op, uint64_t, bang_op)
+
+SPECIALIZE_BANG_BROADCAST_BINARY_INT64_TRAIT(BinaryOp::kAdd, BangBinaryOp::kAdd);
+SPECIALIZE_BANG_BROADCAST_BINARY_INT64_TRAIT(BinaryOp::kSub, BangBinaryOp::kSub);
+SPECIALIZE_BANG_BROADCAST_BINARY_INT64_TRAIT(BinaryOp::kMul, BangBinaryOp::kMul);
+SPECIALIZE_BANG_BROADCAST_BINARY_INT64_TRAIT(BinaryOp::kDiv, BangBinaryOp::kDiv);
+SPECIALIZE_BANG_BROADCAST_BINARY_INT64_TRAIT(BinaryOp::kEqual, BangBinaryOp::kEqual);
+SPECIALIZE_BANG_BROADCAST_BINARY_INT64_TRAIT(BinaryOp::kNotEqual, BangBinaryOp::kNotEqual);
+SPECIALIZE_BANG_BROADCAST_BINARY_INT64_TRAIT(BinaryOp::kGreaterThan, BangBinaryOp::kGreaterThan);
+SPECIALIZE_BANG_BROADCAST_BINARY_INT64_TRAIT(BinaryOp::kGreaterEqual,
+                                             BangBinaryOp::kGreaterEqual);
+SPECIALIZE_BANG_BROADCAST_BINARY_INT64_TRAIT(BinaryOp::kLessThan, BangBinaryOp::kLessThan);
+SPECIALIZE_BANG_BROADCAST_BINARY_INT64_TRAIT(BinaryOp::kLessEqual, BangBinaryOp::kLessEqual);
+
+#undef SPECIALIZE_BANG_BROADCAST_BINARY_INT64_TRAIT
+#undef SPECIALIZE_BANG_BROADCAST_BINARY_TRAIT
+
 inline int64_t ComputeElementCount(size_t ndim, const int64_t* dims) {
   int64_t count = 1;
   for (int i = 0; i < ndim; ++i) { count *= dims[i]; }
   return count;
 }
 
-inline std::vector<int64_t> ComputeBroadcastShape(size_t small_num_dims, const int64_t* small_dims,
-                                                  size_t large_num_dims,
-                                                  const int64_t* large_dims) {
-  std::vector<int64_t> dst_dims(large_num_dims);
-  size_t offset = large_num_dims - small_num_dims;
-  for (int i = 0; i < offset; ++i) { dst_dims[i] = large_dims[i]; }
-  for (int i = offset; i < large_num_dims; ++i) {
-    int64_t dim0 = large_dims[i];
-    int64_t dim1 = small_dims[i - offset];
-    dst_dims[i] = (dim0 > dim1) ? dim0 : dim1;
-  }
-  return dst_dims;
-}
+void LaunchBangBroadcastBinary(Stream* stream, BangBinaryOp op, DataType src_type,
+                               DataType dst_type, size_t num_src0_dims, const int64_t* src0_dims,
+                               const void* src0, size_t num_src1_dims, const int64_t* src1_dims,
+                               const void* src1, void* dst);
 
 template<BinaryOp binary_op, typename Src, typename Dst>
 std::unique_ptr<BroadcastElementwiseBinary> NewBroadcastElementwiseBinary(Scalar attr0,
@@ -17,6 +17,7 @@ limitations under the License.
 #include "oneflow_mlu/cnnl/cnnl_tensor_descriptor.h"
 #include "oneflow_mlu/cnnl/cnnl_workspace.h"
 #include "oneflow_mlu/ep/primitive/type_seq.h"
+#include "oneflow_mlu/ep/primitive/util.h"
 #include "oneflow/core/ep/common/primitive/broadcast_elementwise_binary.h"
 #include "oneflow/core/ep/include/primitive/cast.h"
 #include "oneflow/core/ep/include/primitive/fill.h"
@@ -66,21 +67,29 @@ class BinaryLogical : public BroadcastElementwiseBinary {
 
   void Launch(Stream* stream, size_t num_src0_dims, const int64_t* src0_dims, const void* src0,
               size_t num_src1_dims, const int64_t* src1_dims, const void* src1, void* dst) {
-    CnnlTensorDescriptor src0_desc, src1_desc, dst_desc;
-    std::vector<int64_t> dst_dims;
-    if (num_src0_dims > num_src1_dims) {
-      dst_dims = ComputeBroadcastShape(num_src1_dims, src1_dims, num_src0_dims, src0_dims);
-    } else {
-      dst_dims = ComputeBroadcastShape(num_src0_dims, src0_dims, num_src1_dims, src1_dims);
+    size_t num_dims = 0;
+    int64_t simplified_src0_dims[kMaxNumDims];
+    int64_t simplified_src1_dims[kMaxNumDims];
+    int64_t simplified_dst_dims[kMaxNumDims];
+    SimplifyBroadcastDims(num_src0_dims, src0_dims, num_src1_dims, src1_dims, &num_dims,
+                          simplified_src0_dims, simplified_src1_dims, simplified_dst_dims);
+
+    if constexpr (BangBroadcastBinaryTrait<op, Src>::value) {
+      LaunchBangBroadcastBinary(stream, BangBroadcastBinaryTrait<op, Src>::bang_binary_op,
+                                GetDataType<Src>::value, GetDataType<Dst>::value, num_dims,
+                                simplified_src0_dims, src0, num_dims, simplified_src1_dims, src1,
+                                dst);
+      return;
     }
 
+    CnnlTensorDescriptor src0_desc, src1_desc, dst_desc;
     DataType compute_dtype = GetBinaryComputeDataType<op, Src>();
     CnnlWorkspace cast_workspace(stream->As<ep::MluStream>());
 
     if (compute_dtype != GetDataType<Src>::value) {
       int element_size = GetSizeOfDataType(compute_dtype);
-      int64_t src0_count = ComputeElementCount(num_src0_dims, src0_dims) * element_size;
-      int64_t src1_count = ComputeElementCount(num_src1_dims, src1_dims) * element_size;
+      int64_t src0_count = ComputeElementCount(num_dims, simplified_src0_dims) * element_size;
+      int64_t src1_count = ComputeElementCount(num_dims, simplified_src1_dims) * element_size;
       cast_workspace.resize(src0_count + src1_count);
       char* cast_workspace_dptr = reinterpret_cast<char*>(cast_workspace.dptr());
 
@@ -91,13 +100,13 @@ class BinaryLogical : public BroadcastElementwiseBinary {
       src0 = cast_workspace_dptr;
       src1 = cast_workspace_dptr + src0_count;
       auto cnnl_compute_dtype = ConvertToCnnlDataType(compute_dtype);
-      src0_desc.set(num_src0_dims, src0_dims, cnnl_compute_dtype);
-      src1_desc.set(num_src1_dims, src1_dims, cnnl_compute_dtype);
+      src0_desc.set(num_dims, simplified_src0_dims, cnnl_compute_dtype);
+      src1_desc.set(num_dims, simplified_src1_dims, cnnl_compute_dtype);
     } else {
-      src0_desc.set(num_src0_dims, src0_dims, src_dtype_);
-      src1_desc.set(num_src1_dims, src1_dims, src_dtype_);
+      src0_desc.set(num_dims, simplified_src0_dims, src_dtype_);
+      src1_desc.set(num_dims, simplified_src1_dims, src_dtype_);
     }
-    dst_desc.set(dst_dims.size(), dst_dims.data(), dst_dtype_);
+    dst_desc.set(num_dims, simplified_dst_dims, dst_dtype_);
 
     size_t workspace_size = 0;
     OF_CNNL_CHECK(cnnlGetLogicOpWorkspaceSize(stream->As<ep::MluStream>()->cnnl_handle(),
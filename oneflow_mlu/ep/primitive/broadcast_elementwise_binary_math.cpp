@@ -18,6 +18,7 @@ limitations under the License.
 #include "oneflow_mlu/cnnl/cnnl_tensor_descriptor.h"
 #include "oneflow_mlu/cnnl/cnnl_workspace.h"
 #include "oneflow_mlu/ep/primitive/type_seq.h"
+#include "oneflow_mlu/ep/primitive/util.h"
 #include "oneflow/core/ep/common/primitive/broadcast_elementwise_binary.h"
 #include "oneflow/core/ep/include/primitive/cast.h"
 #include "oneflow/core/ep/include/primitive/fill.h"
@@ -134,20 +135,28 @@ class BinaryMath : public BroadcastElementwiseBinary {
 
   void Launch(Stream* stream, size_t num_src0_dims, const int64_t* src0_dims, const void* src0,
               size_t num_src1_dims, const int64_t* src1_dims, const void* src1, void* dst) {
-    std::vector<int64_t> dst_dims;
-    if (num_src0_dims > num_src1_dims) {
-      dst_dims = ComputeBroadcastShape(num_src1_dims, src1_dims, num_src0_dims, src0_dims);
-    } else {
-      dst_dims = ComputeBroadcastShape(num_src0_dims, src0_dims, num_src1_dims, src1_dims);
+    size_t num_dims = 0;
+    int64_t simplified_src0_dims[kMaxNumDims];
+    int64_t simplified_src1_dims[kMaxNumDims];
+    int64_t simplified_dst_dims[kMaxNumDims];
+    SimplifyBroadcastDims(num_src0_dims, src0_dims, num_src1_dims, src1_dims, &num_dims,
+                          simplified_src0_dims, simplified_src1_dims, simplified_dst_dims);
+
+    if constexpr (BangBroadcastBinaryTrait<op, T>::value) {
+      LaunchBangBroadcastBinary(stream, BangBroadcastBinaryTrait<op, T>::bang_binary_op,
+                                GetDataType<T>::value, GetDataType<T>::value, num_dims,
+                                simplified_src0_dims, src0, num_dims, simplified_src1_dims, src1,
+                                dst);
+      return;
     }
 
     DataType compute_dtype = GetBinaryComputeDataType<op, T>();
     if (compute_dtype != GetDataType<T>::value) {
       CnnlWorkspace cast_workspace(stream->As<ep::MluStream>());
       int element_size = GetSizeOfDataType(compute_dtype);
-      int64_t src0_count = ComputeElementCount(num_src0_dims, src0_dims) * element_size;
-      int64_t src1_count = ComputeElementCount(num_src1_dims, src1_dims) * element_size;
-      int64_t dst_count = ComputeElementCount(dst_dims.size(), dst_dims.data()) * element_size;
+      int64_t src0_count = ComputeElementCount(num_dims, simplified_src0_dims) * element_size;
+      int64_t src1_count = ComputeElementCount(num_dims, simplified_src1_dims) * element_size;
+      int64_t dst_count = ComputeElementCount(num_dims, simplified_dst_dims) * element_size;
       cast_workspace.resize(src0_count + src1_count + dst_count);
 
       char* cast_workspace_dptr = reinterpret_cast<char*>(cast_workspace.dptr());
@@ -158,10 +167,10 @@ class BinaryMath : public BroadcastElementwiseBinary {
 
       auto cnnl_compute_dtype = ConvertToCnnlDataType(compute_dtype);
       CnnlTensorDescriptor src0_desc, src1_desc, dst_desc;
-      src0_desc.set(num_src0_dims, src0_dims, cnnl_compute_dtype);
-      src1_desc.set(num_src1_dims, src1_dims, cnnl_compute_dtype);
+      src0_desc.set(num_dims, simplified_src0_dims, cnnl_compute_dtype);
+      src1_desc.set(num_dims, simplified_src1_dims, cnnl_compute_dtype);
 
-      dst_desc.set(dst_dims.size(), dst_dims.data(), cnnl_compute_dtype);
+      dst_desc.set(num_dims, simplified_dst_dims, cnnl_compute_dtype);
       void* dst_tmp = cast_workspace_dptr + src0_count + src1_count;
       BinaryMathImpl<op, T>()(stream, cnnl_compute_dtype, src0_desc.desc(), cast_workspace_dptr,
                               src1_desc.desc(), cast_workspace_dptr + src0_count, dst_desc.desc(),
@@ -171,9 +180,9 @@ class BinaryMath : public BroadcastElementwiseBinary {
       cast_output->Launch(stream, dst_tmp, dst, dst_count / element_size);
     } else {
       CnnlTensorDescriptor src0_desc, src1_desc, dst_desc;
-      src0_desc.set(num_src0_dims, src0_dims, cnnl_dtype_);
-      src1_desc.set(num_src1_dims, src1_dims, cnnl_dtype_);
-      dst_desc.set(dst_dims.size(), dst_dims.data(), cnnl_dtype_);
+      src0_desc.set(num_dims, simplified_src0_dims, cnnl_dtype_);
+      src1_desc.set(num_dims, simplified_src1_dims, cnnl_dtype_);
+      dst_desc.set(num_dims, simplified_dst_dims, cnnl_dtype_);
       BinaryMathImpl<op, T>()(stream, cnnl_dtype_, src0_desc.desc(), src0, src1_desc.desc(), src1,
                               dst_desc.desc(), dst);
     }
@@ -13,8 +13,9 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 */
-#include "oneflow_mlu/cnnl/cnnl_tensor_descriptor.h"
+#include "oneflow_mlu/cnnl/cnnl_copy.h"
 #include "oneflow_mlu/ep/mlu_stream.h"
+#include "oneflow_mlu/ep/primitive/util.h"
 #include "oneflow/core/ep/include/primitive/copy_nd.h"
 #include "oneflow/core/ep/common/primitive/copy_nd.h"
 
@@ -40,33 +41,36 @@ class CopyNdImpl : public CopyNd {
               const int64_t* dst_dims, const int64_t* dst_pos, const void* src,
               const int64_t* src_dims, const int64_t* src_pos,
               const int64_t* extent) const override {
-    cnnlDataType_t cnnl_data_type = ConvertToCnnlDataType(data_type);
-    CnnlTensorDescriptor input_desc, output_desc;
+    auto* mlu_stream = stream->As<ep::MluStream>();
     if (num_dims == 0) {
-      input_desc.set(num_dims, src_dims, cnnl_data_type);
-      output_desc.set(num_dims, dst_dims, cnnl_data_type);
-    } else {
-      std::vector<int64_t> src_stride(num_dims, 1);
-      std::vector<int64_t> dst_stride(num_dims, 1);
-
-      int src_offset = src_pos[num_dims - 1];
-      int dst_offset = dst_pos[num_dims - 1];
-      for (int i = num_dims - 2; i >= 0; --i) {
-        src_stride[i] = src_stride[i + 1] * src_dims[i + 1];
-        dst_stride[i] = dst_stride[i + 1] * dst_dims[i + 1];
-        src_offset += src_pos[i] * src_stride[i];
-        dst_offset += dst_pos[i] * dst_stride[i];
-      }
-
-      input_desc.set(num_dims, extent, src_stride.data(), cnnl_data_type);
-      output_desc.set(num_dims, extent, dst_stride.data(), cnnl_data_type);
-
-      src = static_cast<const char*>(src) + src_offset * GetSizeOfDataType(data_type);
-      dst = static_cast<char*>(dst) + dst_offset * GetSizeOfDataType(data_type);
+      CnnlStridedCopy(mlu_stream, data_type, 0, extent, src, nullptr, dst, nullptr);
+      return;
+    }
+    int64_t src_stride[kMaxNumDims];
+    int64_t dst_stride[kMaxNumDims];
+    src_stride[num_dims - 1] = 1;
+    dst_stride[num_dims - 1] = 1;
+    int64_t src_offset = src_pos[num_dims - 1];
+    int64_t dst_offset = dst_pos[num_dims - 1];
+    for (int i = num_dims - 2; i >= 0; --i) {
+      src_stride[i] = src_stride[i + 1] * src_dims[i + 1];
+      dst_stride[i] = dst_stride[i + 1] * dst_dims[i + 1];
+      src_offset += src_pos[i] * src_stride[i];
+      dst_offset += dst_pos[i] * dst_stride[i];
     }
 
-    OF_CNNL_CHECK(cnnlCopy(stream->As<ep::MluStream>()->cnnl_handle(), input_desc.desc(), src,
-                           output_desc.desc(), dst));
+    size_t simplified_num_dims = 0;
+    int64_t simplified_extent[kMaxNumDims];
+    int64_t simplified_src_stride[kMaxNumDims];
+    int64_t simplified_dst_stride[kMaxNumDims];
+    mlu::SimplifyStridedCopyDims<kMaxNumDims>(num_dims, extent, src_stride, dst_stride,
+                                              &simplified_num_dims, simplified_extent,
+                                              simplified_src_stride, simplified_dst_stride);
+
+    const int64_t elem_size = GetSizeOfDataType(data_type);
+    CnnlStridedCopy(mlu_stream, data_type, simplified_num_dims, simplified_extent,
+                    static_cast<const char*>(src) + src_offset * elem_size, simplified_src_stride,
+                    static_cast<char*>(dst) + dst_offset * elem_size, simplified_dst_stride);
   }
 };
 
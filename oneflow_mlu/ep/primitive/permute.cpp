@@ -21,6 +21,7 @@ limitations under the License.
 #include "oneflow_mlu/cnnl/cnnl_workspace.h"
 #include "oneflow_mlu/cnnl/cnnl_tensor_descriptor.h"
 #include "oneflow_mlu/cnnl/cnnl_op_descriptor.h"
+#include "oneflow_mlu/ep/primitive/util.h"
 
 namespace oneflow {
 namespace ep {
@@ -28,6 +29,11 @@ namespace primitive {
 
 namespace {
 
+// cnnlTranspose takes at most 8 axes, inputs with more are accepted as long as dropping size-1
+// axes and merging adjacent ones leaves no more than that.
+constexpr size_t kPermuteMaxNumDims = 8;
+constexpr size_t kPermuteMaxInputNumDims = 20;
+
 class PermuteImpl : public Permute {
  public:
   OF_DISALLOW_COPY_AND_MOVE(PermuteImpl);
@@ -36,16 +42,38 @@ class PermuteImpl : public Permute {
   using Permute::Launch;
   void Launch(Stream* stream, DataType data_type, size_t num_dims, const int64_t* src_dims,
               const void* src, const int* permutation, void* dst) override {
+    CHECK_LE(num_dims, kPermuteMaxInputNumDims);
+    size_t simplified_num_dims = 0;
+    int64_t simplified_src_dims[kPermuteMaxInputNumDims];
+    int simplified_permutation[kPermuteMaxInputNumDims];
+    mlu::SimplifyPermutation<kPermuteMaxInputNumDims>(num_dims, src_dims, permutation,
+                                                      &simplified_num_dims, simplified_src_dims,
+                                                      simplified_permutation);
+    if (simplified_num_dims == 1) {
+      // the permutation only moves size-1 axes, so the memory layout is unchanged
+      size_t count = simplified_src_dims[0] * GetSizeOfDataType(data_type);
+      if (count == 0 || src == dst) { return; }
+      OF_MLU_CHECK(cnrtMemcpyAsync(dst, const_cast<void*>(src), count,
+                                   stream->As<ep::MluStream>()->mlu_stream(),
+                                   cnrtMemcpyDevToDev));
+      return;
+    }
+
+    CHECK_LE(simplified_num_dims, kPermuteMaxNumDims)
+        << "MLU permute supports at most " << kPermuteMaxNumDims
+        << " axes after dropping size-1 axes and merging adjacent ones, the " << num_dims
+        << "-d permutation leaves " << simplified_num_dims;
     CnnlTransposeDescriptor tran_desc;
-
-    tran_desc.set(num_dims, permutation);
-    int64_t dst_dims[num_dims];
-    for (size_t i = 0; i < num_dims; ++i) { dst_dims[i] = src_dims[permutation[i]]; }
+    tran_desc.set(simplified_num_dims, simplified_permutation);
+    int64_t dst_dims[kPermuteMaxNumDims];
+    for (size_t i = 0; i < simplified_num_dims; ++i) {
+      dst_dims[i] = simplified_src_dims[simplified_permutation[i]];
+    }
 
     cnnlDataType_t cnnl_data_type = ConvertToCnnlDataType(data_type);
     CnnlTensorDescriptor input_desc, output_desc;
-    input_desc.set(num_dims, src_dims, cnnl_data_type);
-    output_desc.set(num_dims, dst_dims, cnnl_data_type);
+    input_desc.set(simplified_num_dims, simplified_src_dims, cnnl_data_type);
+    output_desc.set(simplified_num_dims, dst_dims, cnnl_data_type);
 
     size_t workspace_size = 0;
     OF_CNNL_CHECK(cnnlGetTransposeWorkspaceSize(stream->As<ep::MluStream>()->cnnl_handle(),
@@ -67,6 +95,8 @@ class PermuteFactoryImpl : public PermuteFactory {
   ~PermuteFactoryImpl() override = default;
 
   std::unique_ptr<Permute> New(size_t max_num_dims) override {
+    CHECK_LE(max_num_dims, kPermuteMaxInputNumDims)
+        << "MLU permute supports inputs of at most " << kPermuteMaxInputNumDims << " axes";
     return std::unique_ptr<Permute>(new PermuteImpl());
   }
 };
@@ -0,0 +1,163 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CAMBRICON_EP_PRIMITIVE_UTIL_H_
+#define ONEFLOW_CAMBRICON_EP_PRIMITIVE_UTIL_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace oneflow {
+namespace ep {
+namespace primitive {
+namespace mlu {
+
+// Drop the axes whose broadcast size is 1 and merge adjacent axes that have the same
+// broadcast pattern, e.g. (N, C, H, W) + (1, C, 1, 1) is simplified to (N, C, H * W) +
+// (1, C, 1). Simplified src0 and src1 dims always have the same number of axes.
+inline void SimplifyBroadcastDims(size_t num_src0_dims, const int64_t* src0_dims,
+                                  size_t num_src1_dims, const int64_t* src1_dims,
+                                  size_t* simplified_num_dims, int64_t* simplified_src0_dims,
+                                  int64_t* simplified_src1_dims, int64_t* simplified_dst_dims) {
+  const size_t num_dims = num_src0_dims > num_src1_dims ? num_src0_dims : num_src1_dims;
+  const size_t src0_offset = num_dims - num_src0_dims;
+  const size_t src1_offset = num_dims - num_src1_dims;
+  size_t count = 0;
+  bool prev_broadcast_src0 = false;
+  bool prev_broadcast_src1 = false;
+  for (size_t i = 0; i < num_dims; ++i) {
+    const int64_t src0_dim = i < src0_offset ? 1 : src0_dims[i - src0_offset];
+    const int64_t src1_dim = i < src1_offset ? 1 : src1_dims[i - src1_offset];
+    const int64_t dst_dim = src0_dim == 1 ? src1_dim : src0_dim;
+    if (dst_dim == 1) { continue; }
+    const bool broadcast_src0 = src0_dim == 1;
+    const bool broadcast_src1 = src1_dim == 1;
+    if (count > 0 && broadcast_src0 == prev_broadcast_src0
+        && broadcast_src1 == prev_broadcast_src1) {
+      simplified_src0_dims[count - 1] *= src0_dim;
+      simplified_src1_dims[count - 1] *= src1_dim;
+      simplified_dst_dims[count - 1] *= dst_dim;
+    } else {
+      simplified_src0_dims[count] = src0_dim;
+      simplified_src1_dims[count] = src1_dim;
+      simplified_dst_dims[count] = dst_dim;
+      count += 1;
+    }
+    prev_broadcast_src0 = broadcast_src0;
+    prev_broadcast_src1 = broadcast_src1;
+  }
+  if (count == 0) {
+    simplified_src0_dims[0] = 1;
+    simplified_src1_dims[0] = 1;
+    simplified_dst_dims[0] = 1;
+    count = 1;
+  }
+  *simplified_num_dims = count;
+}
+
+// Drop the axes of size 1 and merge the src axes which stay adjacent and in order after
+// permutation, e.g. (A, B, C, D) with permutation (2, 3, 0, 1) is simplified to
+// (A * B, C * D) with permutation (1, 0).
+template<size_t max_num_dims>
+inline void SimplifyPermutation(size_t num_dims, const int64_t* src_dims, const int* permutation,
+                                size_t* simplified_num_dims, int64_t* simplified_src_dims,
+                                int* simplified_permutation) {
+  int compact_axis[max_num_dims];
+  int64_t compact_dims[max_num_dims];
+  size_t num_compact_dims = 0;
+  for (size_t i = 0; i < num_dims; ++i) {
+    if (src_dims[i] == 1) {
+      compact_axis[i] = -1;
+    } else {
+      compact_axis[i] = num_compact_dims;
+      compact_dims[num_compact_dims] = src_dims[i];
+      num_compact_dims += 1;
+    }
+  }
+  int compact_permutation[max_num_dims];
+  size_t num_permuted = 0;
+  for (size_t i = 0; i < num_dims; ++i) {
+    const int axis = compact_axis[permutation[i]];
+    if (axis >= 0) { compact_permutation[num_permuted++] = axis; }
+  }
+  if (num_permuted == 0) {
+    simplified_src_dims[0] = 1;
+    simplified_permutation[0] = 0;
+    *simplified_num_dims = 1;
+    return;
+  }
+  // groups of src axes that are consecutive in both src and dst, in dst order
+  int group_start[max_num_dims];
+  int64_t group_dims[max_num_dims];
+  size_t num_groups = 0;
+  for (size_t i = 0; i < num_permuted; ++i) {
+    const int axis = compact_permutation[i];
+    if (i > 0 && axis == compact_permutation[i - 1] + 1) {
+      group_dims[num_groups - 1] *= compact_dims[axis];
+    } else {
+      group_start[num_groups] = axis;
+      group_dims[num_groups] = compact_dims[axis];
+      num_groups += 1;
+    }
+  }
+  for (size_t i = 0; i < num_groups; ++i) {
+    int rank = 0;
+    for (size_t j = 0; j < num_groups; ++j) {
+      if (group_start[j] < group_start[i]) { rank += 1; }
+    }
+    simplified_src_dims[rank] = group_dims[i];
+    simplified_permutation[i] = rank;
+  }
+  *simplified_num_dims = num_groups;
+}
+
+// Drop the axes of extent 1 and merge adjacent axes which are contiguous in both src and
+// dst, so that copies of full rows or planes become a single large block.
+template<size_t max_num_dims>
+inline void SimplifyStridedCopyDims(size_t num_dims, const int64_t* extent,
+                                    const int64_t* src_strides, const int64_t* dst_strides,
+                                    size_t* simplified_num_dims, int64_t* simplified_extent,
+                                    int64_t* simplified_src_strides,
+                                    int64_t* simplified_dst_strides) {
+  size_t count = 0;
+  for (size_t i = 0; i < num_dims; ++i) {
+    if (extent[i] == 1) { continue; }
+    if (count > 0 && simplified_src_strides[count - 1] == src_strides[i] * extent[i]
+        && simplified_dst_strides[count - 1] == dst_strides[i] * extent[i]) {
+      simplified_extent[count - 1] *= extent[i];
+      simplified_src_strides[count - 1] = src_strides[i];
+      simplified_dst_strides[count - 1] = dst_strides[i];
+    } else {
+      simplified_extent[count] = extent[i];
+      simplified_src_strides[count] = src_strides[i];
+      simplified_dst_strides[count] = dst_strides[i];
+      count += 1;
+    }
+  }
+  if (count == 0) {
+    simplified_extent[0] = 1;
+    simplified_src_strides[0] = 1;
+    simplified_dst_strides[0] = 1;
+    count = 1;
+  }
+  *simplified_num_dims = count;
+}
+
+}  // namespace mlu
+}  // namespace primitive
+}  // namespace ep
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CAMBRICON_EP_PRIMITIVE_UTIL_H_
@@ -18,15 +18,14 @@ limitations under the License.
 #include "oneflow_mlu/kernels/mlu_check_numerics_kernel_observer.h"
 #include "oneflow_mlu/ep/mlu_stream.h"
 #include "oneflow_mlu/ep/mlu_device.h"
+#include "oneflow_mlu/ep/mlu_completion_poller.h"
 #include "oneflow_mlu/common/mlu_guard.h"
 
-#include "oneflow/core/profiler/profiler.h"
 #include "oneflow/core/job/global_for.h"
 #include "oneflow/core/common/device_type.h"
 #include "oneflow/core/kernel/chain_kernel_observer.h"
 #include "oneflow/core/graph/stream_id.h"
 #include "oneflow/core/ep/include/device_manager_registry.h"
-#include "oneflow/core/common/channel.h"
 
 namespace oneflow {
 
@@ -46,8 +45,7 @@ class MluStreamContext : public StreamContext, public KernelObserverProvider {
 
  private:
   ep::MluStream* stream_;
-  Channel<std::pair<ep::Event*, std::function<void()>>> cb_event_chan_;
-  std::thread poller_thread_;
+  std::unique_ptr<ep::MluCallbackQueue> callback_queue_;
   int device_index_;
   std::unique_ptr<KernelObserver> kernel_observer_;
   std::shared_ptr<ep::MluDevice> device_;
@@ -70,32 +68,17 @@ MluStreamContext::MluStreamContext(int device_index)
     kernel_observers.emplace_back(new MluCheckNumericsKernelObserver());
   }
   kernel_observer_.reset(new ChainKernelObserver(kernel_observers));
-
-  poller_thread_ = std::thread([this]() {
-    CHECK_JUST(stream_->OnExecutionContextSetup());
-    OF_PROFILER_NAME_THIS_HOST_THREAD("_mlu" + std::to_string(device_index_) + " Poller : ("
-                                      + std::to_string(device_index_) + ")");
-    std::pair<ep::Event*, std::function<void()>> cb_event;
-    while (cb_event_chan_.Receive(&cb_event) == kChannelStatusSuccess) {
-      CHECK_JUST(cb_event.first->Sync());
-      cb_event.second();
-      device_->DestroyEvent(cb_event.first);
-    }
-    CHECK_JUST(stream_->OnExecutionContextTeardown());
-  });
+  callback_queue_.reset(new ep::MluCallbackQueue(device_.get(), stream_->mlu_stream()));
 }
 
 MluStreamContext::~MluStreamContext() {
   MluCurrentDeviceGuard guard(device_index_);
-  cb_event_chan_.Close();
-  poller_thread_.join();
+  callback_queue_.reset();
   device_->DestroyStream(stream_);
 }
 
 Maybe<void> MluStreamContext::AddCallback(std::function<void()> callback) {
-  ep::Event* event = device_->CreateEvent();
-  stream_->RecordEvent(event);
-  cb_event_chan_.Send(std::make_pair(event, std::move(callback)));
+  callback_queue_->AddCallback(std::move(callback));
   return Maybe<void>::Ok();
 }
 
@@ -15,6 +15,9 @@ limitations under the License.
 */
 #include "oneflow_mlu/cnnl/cnnl_workspace.h"
 #include "oneflow_mlu/cnnl/cnnl_tensor_descriptor.h"
+#include "oneflow_mlu/kernels/pooling_util.h"
+#include "oneflow/core/ep/include/primitive/broadcast_elementwise_binary.h"
+#include "oneflow/core/ep/include/primitive/fill.h"
 #include "oneflow/user/kernels/convert_memory_format_util.h"
 #include "oneflow/user/ops/convert_memory_format_op.h"
 
@@ -33,6 +36,14 @@ class AdaptiveAvgPool2DKernel final : public user_op::OpKernel {
     const user_op::Tensor* in_tensor = ctx->Tensor4ArgNameAndIndex("x", 0);
     user_op::Tensor* out_tensor = ctx->Tensor4ArgNameAndIndex("y", 0);
     const std::string& data_format = ctx->Attr<std::string>("data_format");
+    mlu::AdaptivePoolingReduceView view;
+    if (mlu::GetAdaptivePoolingReduceView(in_tensor->shape_view(), out_tensor->shape_view(),
+                                          data_format == "channels_last", &view)) {
+      mlu::LaunchAdaptivePoolingReduce(ctx->stream(), in_tensor->data_type(), view,
+                                       CNNL_REDUCE_AVG, in_tensor->dptr(), out_tensor->mut_dptr(),
+                                       /*indices=*/nullptr);
+      return;
+    }
     cnnlDataType_t dtype = ConvertToCnnlDataType(in_tensor->data_type());
     CnnlTensorDescriptor in_desc, out_desc;
 
@@ -46,9 +57,9 @@ class AdaptiveAvgPool2DKernel final : public user_op::OpKernel {
     }
 
     size_t tmp_in_workspace_size =
-        in_tensor->shape_view().elem_cnt() * sizeof(in_tensor->data_type());
+        in_tensor->shape_view().elem_cnt() * GetSizeOfDataType(in_tensor->data_type());
     size_t tmp_out_workspace_size =
-        out_tensor->shape_view().elem_cnt() * sizeof(out_tensor->data_type());
+        out_tensor->shape_view().elem_cnt() * GetSizeOfDataType(out_tensor->data_type());
     CnnlWorkspace tmp_in_cnnl_workspace(ctx->stream()->As<ep::MluStream>(), tmp_in_workspace_size);
     CnnlWorkspace tmp_out_cnnl_workspace(ctx->stream()->As<ep::MluStream>(),
                                          tmp_out_workspace_size);
@@ -124,6 +135,12 @@ class AdaptiveAvgPool2DGradKernel final : public user_op::OpKernel {
     CHECK_EQ(x_tensor->shape_view().NumAxes(), 4);
 
     const std::string& data_format = ctx->Attr<std::string>("data_format");
+    mlu::AdaptivePoolingReduceView view;
+    if (mlu::GetAdaptivePoolingReduceView(dx_tensor->shape_view(), dy_tensor->shape_view(),
+                                          data_format == "channels_last", &view)) {
+      ComputeEvenWindows(ctx, view, dy_tensor, dx_tensor);
+      return;
+    }
     if (data_format == "channels_last") {
       ComputeNHWC(ctx, dy_tensor, dx_tensor);
       return;
@@ -133,7 +150,7 @@ class AdaptiveAvgPool2DGradKernel final : public user_op::OpKernel {
     auto dtype = ConvertToCnnlDataType(dy_tensor->data_type());
 
     size_t tmp_dy_workspace_size =
-        dy_tensor->shape_view().elem_cnt() * sizeof(dy_tensor->data_type());
+        dy_tensor->shape_view().elem_cnt() * GetSizeOfDataType(dy_tensor->data_type());
     CnnlWorkspace tmp_dy_cnnl_workspace(ctx->stream()->As<ep::MluStream>(), tmp_dy_workspace_size);
     void* tmp_dy_ptr = tmp_dy_cnnl_workspace.dptr();
 
@@ -149,7 +166,7 @@ class AdaptiveAvgPool2DGradKernel final : public user_op::OpKernel {
     dx_desc.set(dx_tensor->shape_view().NumAxes(), dx_shape.data(), dtype, CNNL_LAYOUT_NHWC);
 
     size_t tmp_dx_workspace_size =
-        dx_tensor->shape_view().elem_cnt() * sizeof(dy_tensor->data_type());
+        dx_tensor->shape_view().elem_cnt() * GetSizeOfDataType(dy_tensor->data_type());
     CnnlWorkspace tmp_dx_cnnl_workspace(ctx->stream()->As<ep::MluStream>(), tmp_dx_workspace_size);
     void* tmp_dx_ptr = tmp_dx_cnnl_workspace.dptr();
 
@@ -168,6 +185,28 @@ class AdaptiveAvgPool2DGradKernel final : public user_op::OpKernel {
                         MemoryFormat::kContiguous);
   }
 
+  // every element of a window receives dy / window_size, broadcast dy against a window filled
+  // with 1 / window_size in one pass
+  void ComputeEvenWindows(user_op::KernelComputeContext* ctx,
+                          const mlu::AdaptivePoolingReduceView& view,
+                          const user_op::Tensor* dy_tensor, user_op::Tensor* dx_tensor) const {
+    const DataType data_type = dy_tensor->data_type();
+    const size_t num_dims = view.in_dims.size();
+    DimVector window_dims(num_dims, 1);
+    for (int32_t axis : view.axes) { window_dims[axis] = view.in_dims[axis]; }
+    CnnlWorkspace window(ctx->stream()->As<ep::MluStream>(),
+                         view.window_size * GetSizeOfDataType(data_type));
+    auto fill = ep::primitive::NewPrimitive<ep::primitive::FillFactory>(DeviceType::kMLU,
+                                                                        data_type);
+    CHECK(fill);
+    fill->Launch(ctx->stream(), window.dptr(), Scalar(1.0 / view.window_size), view.window_size);
+    auto mul = ep::primitive::NewPrimitive<ep::primitive::BroadcastElementwiseBinaryFactory>(
+        DeviceType::kMLU, ep::primitive::BinaryOp::kMul, data_type, data_type, num_dims);
+    CHECK(mul);
+    mul->Launch(ctx->stream(), num_dims, view.out_dims.data(), dy_tensor->dptr(), num_dims,
+                window_dims.data(), window.dptr(), dx_tensor->mut_dptr());
+  }
+
   void ComputeNHWC(user_op::KernelComputeContext* ctx, const user_op::Tensor* dy_tensor,
                    user_op::Tensor* dx_tensor) const {
     auto dtype = ConvertToCnnlDataType(dy_tensor->data_type());
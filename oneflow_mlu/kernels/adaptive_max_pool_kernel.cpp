@@ -15,6 +15,7 @@ limitations under the License.
 */
 #include "oneflow_mlu/cnnl/cnnl_workspace.h"
 #include "oneflow_mlu/cnnl/cnnl_tensor_descriptor.h"
+#include "oneflow_mlu/kernels/pooling_util.h"
 #include "oneflow/user/kernels/convert_memory_format_util.h"
 #include "oneflow/user/ops/convert_memory_format_op.h"
 
@@ -23,81 +24,24 @@ namespace oneflow {
 namespace {
 
 void PrepareIndexDescAndWorkspace(user_op::KernelComputeContext* ctx,
-                                  const std::string& data_format, cnnlDataType_t local_index_dtype,
-                                  CnnlTensorDescriptor& index_desc,
+                                  const std::string& data_format, DataType local_index_data_type,
                                   CnnlTensorDescriptor& local_index_desc,
                                   CnnlWorkspace& local_index) {
-  // prepare index desc and workspace
+  // prepare index desc and workspace, cnnl computes the window local index in int32 for float
+  // inputs and int16 for half inputs while the op holds it as int64
   const user_op::Tensor* index = ctx->Tensor4ArgNameAndIndex("index", 0);
   cnnlTensorLayout_t layout = CNNL_LAYOUT_NHWC;
-  // cnnlPoolingForwardWithIndex requires index_desc->dtype == CNNL_DTYPE_INT32 or
-  // CNNL_DTYPE_INT16 But in oneflow/user/ops/max_pool_op.cpp its dtype is set as kInt64.
-  // cnnlPoolingForwardWithIndex requires index dtype is int32 for float input,
-  // and index dtype is int16 for half input
-  if (local_index_dtype == CNNL_DTYPE_INT32) {
-    local_index.resize(sizeof(int32_t) * index->shape_view().elem_cnt());
-  } else if (local_index_dtype == CNNL_DTYPE_INT16) {
-    // elem_cnt * 1 for int16, additional elem_cnt * 2 for casting int16 to int32
-    local_index.resize(sizeof(int16_t) * index->shape_view().elem_cnt() * 3);
-  } else {
-    UNIMPLEMENTED() << "invalid CNNL DType " << local_index_dtype;
-  }
+  cnnlDataType_t local_index_dtype = ConvertToCnnlDataType(local_index_data_type);
+  local_index.resize(GetSizeOfDataType(local_index_data_type) * index->shape_view().elem_cnt());
   if (data_format == "channels_last") {
-    index_desc.set(index->shape_view().size(), index->shape_view().data(),
-                   ConvertToCnnlDataType(index->data_type()), layout);
     local_index_desc.set(index->shape_view().NumAxes(), index->shape_view().data(),
                          local_index_dtype, layout);
   } else {
     auto shape = ComputeShapeContiguousToChannelsLast(Shape(index->shape_view()));
-    index_desc.set(index->shape_view().size(), shape.data(),
-                   ConvertToCnnlDataType(index->data_type()), CNNL_LAYOUT_NHWC);
     local_index_desc.set(index->shape_view().NumAxes(), shape.data(), local_index_dtype, layout);
   }
 }
 
-void ConvertShortIndexToLong(ep::Stream* stream, cnnlDataType_t local_index_dtype,
-                             const ShapeView& index_shape, const CnnlTensorDescriptor& index_desc,
-                             void* index_ptr, const CnnlTensorDescriptor& local_index_desc,
-                             CnnlWorkspace& local_index) {
-  // cast int32/int16 index to int64 index
-  CnnlTensorDescriptor int32_index_desc;
-  char* int32_index_dptr = reinterpret_cast<char*>(local_index.dptr());
-  if (local_index_dtype == CNNL_DTYPE_INT16) {
-    int32_index_dptr += sizeof(int16_t) * index_shape.elem_cnt();
-    int32_index_desc.set(index_shape.NumAxes(), index_shape.data(), CNNL_DTYPE_INT32,
-                         CNNL_LAYOUT_NHWC);
-    OF_CNNL_CHECK(cnnlCastDataType(
-        stream->As<ep::MluStream>()->cnnl_handle(), local_index_desc.desc(), local_index.dptr(),
-        CNNL_CAST_INT16_TO_INT32, int32_index_desc.desc(), int32_index_dptr));
-  }
-  OF_CNNL_CHECK(cnnlCastDataType(
-      stream->As<ep::MluStream>()->cnnl_handle(),
-      (local_index_dtype == CNNL_DTYPE_INT16) ? int32_index_desc.desc() : local_index_desc.desc(),
-      int32_index_dptr, CNNL_CAST_INT32_TO_INT64, index_desc.desc(), index_ptr));
-}
-
-void ConvertLongIndexToShort(ep::Stream* stream, cnnlDataType_t local_index_dtype,
-                             const ShapeView& index_shape, const CnnlTensorDescriptor& index_desc,
-                             const void* index_ptr, const CnnlTensorDescriptor& local_index_desc,
-                             CnnlWorkspace& local_index) {
-  // cast int64 index to int32/int16 index
-  CnnlTensorDescriptor int32_index_desc;
-  char* int32_index_dptr = reinterpret_cast<char*>(local_index.dptr());
-  if (local_index_dtype == CNNL_DTYPE_INT16) {
-    int32_index_dptr += sizeof(int16_t) * index_shape.elem_cnt();
-  }
-  int32_index_desc.set(index_shape.NumAxes(), index_shape.data(), CNNL_DTYPE_INT32,
-                       CNNL_LAYOUT_NHWC);
-  OF_CNNL_CHECK(cnnlCastDataType(stream->As<ep::MluStream>()->cnnl_handle(), index_desc.desc(),
-                                 index_ptr, CNNL_CAST_INT64_TO_INT32, int32_index_desc.desc(),
-                                 int32_index_dptr));
-  if (local_index_dtype == CNNL_DTYPE_INT16) {
-    OF_CNNL_CHECK(cnnlCastDataType(
-        stream->As<ep::MluStream>()->cnnl_handle(), int32_index_desc.desc(), int32_index_dptr,
-        CNNL_CAST_INT32_TO_INT16, local_index_desc.desc(), local_index.dptr()));
-  }
-}
-
 }  // namespace
 
 template<typename T>
@@ -114,14 +58,31 @@ class AdaptiveMaxPool2DKernel final : public user_op::OpKernel {
     user_op::Tensor* out_tensor = ctx->Tensor4ArgNameAndIndex("y", 0);
     user_op::Tensor* index_tensor = ctx->Tensor4ArgNameAndIndex("index", 0);
     const std::string& data_format = ctx->Attr<std::string>("data_format");
+    const int64_t index_elem_cnt = index_tensor->shape_view().elem_cnt();
 
-    CnnlTensorDescriptor in_desc, out_desc, index_desc, local_index_desc;
+    CnnlTensorDescriptor in_desc, out_desc, local_index_desc;
     CnnlWorkspace local_index(ctx->stream()->As<ep::MluStream>());
 
+    // the window index of a single window axis matches the cnnl local index, and the NHWC order
+    // the index is kept in is the reduce order for channels_last or a 1x1 output
+    mlu::AdaptivePoolingReduceView view;
+    const bool channels_last = data_format == "channels_last";
+    if (mlu::GetAdaptivePoolingReduceView(in_tensor->shape_view(), out_tensor->shape_view(),
+                                          channels_last, &view)
+        && view.axes.size() == 1 && (channels_last || out_tensor->shape_view().Count(2) == 1)) {
+      local_index.resize(index_elem_cnt * sizeof(int32_t));
+      mlu::LaunchAdaptivePoolingReduce(ctx->stream(), in_tensor->data_type(), view,
+                                       CNNL_REDUCE_MAX, in_tensor->dptr(), out_tensor->mut_dptr(),
+                                       static_cast<int32_t*>(local_index.dptr()));
+      mlu::WidenPoolingIndex(ctx->stream(), DataType::kInt32, index_elem_cnt, local_index.dptr(),
+                             index_tensor->mut_dptr<int64_t>());
+      return;
+    }
+
     cnnlDataType_t dtype = ConvertToCnnlDataType(in_tensor->data_type());
-    cnnlDataType_t local_index_dtype =
-        in_tensor->data_type() == DataType::kFloat16 ? CNNL_DTYPE_INT16 : CNNL_DTYPE_INT32;
-    PrepareIndexDescAndWorkspace(ctx, data_format, local_index_dtype, index_desc, local_index_desc,
+    const DataType local_index_data_type =
+        mlu::GetPoolingLocalIndexDataType(in_tensor->data_type());
+    PrepareIndexDescAndWorkspace(ctx, data_format, local_index_data_type, local_index_desc,
                                  local_index);
     if (data_format == "channels_last") {
       in_desc.set(in_tensor->shape_view().NumAxes(), in_tensor->shape_view().data(), dtype,
@@ -130,8 +91,8 @@ class AdaptiveMaxPool2DKernel final : public user_op::OpKernel {
                    CNNL_LAYOUT_NHWC);
       ComputeNHWC(ctx, local_index_desc, local_index, in_desc, in_tensor->dptr(), out_desc,
                   out_tensor->mut_dptr());
-      ConvertShortIndexToLong(ctx->stream(), local_index_dtype, index_tensor->shape_view(),
-                              index_desc, index_tensor->mut_dptr(), local_index_desc, local_index);
+      mlu::WidenPoolingIndex(ctx->stream(), local_index_data_type, index_elem_cnt,
+                             local_index.dptr(), index_tensor->mut_dptr<int64_t>());
       return;
     }
 
@@ -158,9 +119,8 @@ class AdaptiveMaxPool2DKernel final : public user_op::OpKernel {
     ConvertMemoryFormat(ctx->stream(), out_shape, out_tensor->data_type(), temp_out_ptr,
                         out_tensor->mut_dptr(), MemoryFormat::kChannelsLast,
                         MemoryFormat::kContiguous);
-    auto index_shape = ComputeShapeContiguousToChannelsLast(Shape(index_tensor->shape_view()));
-    ConvertShortIndexToLong(ctx->stream(), local_index_dtype, index_shape, index_desc,
-                            index_tensor->mut_dptr(), local_index_desc, local_index);
+    mlu::WidenPoolingIndex(ctx->stream(), local_index_data_type, index_elem_cnt,
+                           local_index.dptr(), index_tensor->mut_dptr<int64_t>());
     // TODO(): convert nhwc index to nchw
   }
 
@@ -216,18 +176,20 @@ class AdaptiveMaxPool2DGradKernel final : public user_op::OpKernel {
     CHECK_EQ(dx_tensor->shape_view().NumAxes(), 4);
     const std::string& data_format = ctx->Attr<std::string>("data_format");
 
-    CnnlTensorDescriptor dy_desc, dx_desc, index_desc, local_index_desc;
+    CnnlTensorDescriptor dy_desc, dx_desc, local_index_desc;
     CnnlWorkspace local_index(ctx->stream()->As<ep::MluStream>());
 
     cnnlDataType_t dtype = ConvertToCnnlDataType(dx_tensor->data_type());
-    cnnlDataType_t local_index_dtype =
-        dx_tensor->data_type() == DataType::kFloat16 ? CNNL_DTYPE_INT16 : CNNL_DTYPE_INT32;
-    PrepareIndexDescAndWorkspace(ctx, data_format, local_index_dtype, index_desc, local_index_desc,
+    const DataType local_index_data_type =
+        mlu::GetPoolingLocalIndexDataType(dx_tensor->data_type());
+    PrepareIndexDescAndWorkspace(ctx, data_format, local_index_data_type, local_index_desc,
                                  local_index);
+    // the forward pass stores the index in NHWC order for both data formats
+    mlu::NarrowPoolingIndex(ctx->stream(), local_index_data_type,
+                            index_tensor->shape_view().elem_cnt(), index_tensor->dptr<int64_t>(),
+                            local_index.dptr());
 
     if (data_format == "channels_last") {
-      ConvertLongIndexToShort(ctx->stream(), local_index_dtype, index_tensor->shape_view(),
-                              index_desc, index_tensor->dptr(), local_index_desc, local_index);
 
       dy_desc.set(dy_tensor->shape_view().NumAxes(), dy_tensor->shape_view().data(), dtype,
                   CNNL_LAYOUT_NHWC);
@@ -238,10 +200,6 @@ class AdaptiveMaxPool2DGradKernel final : public user_op::OpKernel {
       return;
     }
 
-    auto index_shape = ComputeShapeContiguousToChannelsLast(Shape(index_tensor->shape_view()));
-    ConvertLongIndexToShort(ctx->stream(), local_index_dtype, index_shape, index_desc,
-                            index_tensor->dptr(), local_index_desc, local_index);
-
     size_t tmp_dy_workspace_size =
         dy_tensor->shape_view().elem_cnt() * GetSizeOfDataType(dy_tensor->data_type());
     size_t tmp_dx_workspace_size =
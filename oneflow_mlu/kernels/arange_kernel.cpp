@@ -13,6 +13,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 */
+#include "oneflow_mlu/bang/bang_kernels.h"
 #include "oneflow_mlu/cnnl/cnnl_tensor_descriptor.h"
 #include "oneflow_mlu/cnnl/cnnl_types.h"
 #include "oneflow_mlu/cnnl/cnnl_workspace.h"
@@ -29,17 +30,25 @@ namespace {
 
 class ArangeOpKernelCache final : public user_op::OpKernelCache {
  public:
-  ArangeOpKernelCache(int32_t lower, int32_t upper) : lower_(lower), upper_(upper) {}
+  ArangeOpKernelCache(int64_t lower, int64_t upper) : lower_(lower), upper_(upper) {}
   ~ArangeOpKernelCache() override = default;
 
-  int32_t lower() const { return lower_; }
-  int32_t upper() const { return upper_; }
+  int64_t lower() const { return lower_; }
+  int64_t upper() const { return upper_; }
 
  private:
-  const int32_t lower_;
-  const int32_t upper_;
+  const int64_t lower_;
+  const int64_t upper_;
 };
 
+// int64, uint64 and double are generated by a BANG kernel in their own type, cnnlArange_v2 only
+// covers int32, float and half.
+template<typename T>
+struct IsBangArangeType
+    : std::integral_constant<bool, std::is_same<T, int64_t>::value
+                                       || std::is_same<T, uint64_t>::value
+                                       || std::is_same<T, double>::value> {};
+
 }  // namespace
 
 template<typename T>
@@ -87,61 +96,72 @@ class MluArangeKernel final : public user_op::OpKernel {
                const user_op::OpKernelCache* cache) const override {
     user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
     const DataType dtype = ctx->Attr<DataType>("dtype");
-    int32_t start_int = 0;
-    int32_t step_int = 0;
-    float start_float = 0.0;
-    float step_float = 0.0;
-
-    DataType tmp_out_data_type;
-    size_t tmp_out_workspace_size = out->shape_view().elem_cnt();
-    if (IsIntegralDataType(dtype)) {
-      tmp_out_workspace_size *= GetSizeOfDataType(DataType::kInt32);
-      tmp_out_data_type = DataType::kInt32;
-    } else if (dtype == DataType::kFloat16) {
-      tmp_out_workspace_size *= GetSizeOfDataType(DataType::kFloat16);
-      tmp_out_data_type = DataType::kFloat16;
-    } else {
-      tmp_out_workspace_size *= GetSizeOfDataType(kFloat);
-      tmp_out_data_type = DataType::kFloat;
-    }
-    CnnlTensorDescriptor tmp_out_desc;
-    tmp_out_desc.set(out, ConvertToCnnlDataType(tmp_out_data_type));
-
-    void* tmp_out_ptr = out->mut_dptr<T>();
-    CnnlWorkspace tmp_out_cnnl_workspace(ctx->stream()->As<ep::MluStream>(), 0);
-    if (tmp_out_data_type != dtype) {
-      tmp_out_cnnl_workspace.resize(tmp_out_workspace_size);
-      tmp_out_ptr = tmp_out_cnnl_workspace.dptr();
-    }
+    // a shard of a split arange starts at the lower bound of its slice of the logical range
+    const int64_t lower =
+        cache ? dynamic_cast<const ArangeOpKernelCache*>(cache)->lower() : int64_t(0);
 
-    if (IsIntegralDataType(GetDataType<T>::value)) {
-      start_int = static_cast<int32_t>(ctx->Attr<int64_t>("integer_start"));
-      step_int = static_cast<int32_t>(ctx->Attr<int64_t>("integer_delta"));
-      if (cache) {
-        const auto* arange_cache = dynamic_cast<const ArangeOpKernelCache*>(cache);
-        start_int += step_int * arange_cache->lower();
+    if constexpr (IsBangArangeType<T>::value) {
+      T start = 0;
+      T delta = 0;
+      if (IsIntegralDataType(dtype)) {
+        delta = static_cast<T>(ctx->Attr<int64_t>("integer_delta"));
+        start = static_cast<T>(ctx->Attr<int64_t>("integer_start")) + static_cast<T>(lower) * delta;
+      } else {
+        delta = static_cast<T>(ctx->Attr<double>("float_delta"));
+        start = static_cast<T>(ctx->Attr<double>("float_start")) + static_cast<T>(lower) * delta;
       }
-      OF_CNNL_CHECK(cnnlArange_v2(ctx->stream()->As<ep::MluStream>()->cnnl_handle(),
-                                  CNNL_COMPUTATION_HIGH_PRECISION, (void*)&start_int,
-                                  (void*)&step_int, tmp_out_desc.desc(), tmp_out_ptr));
+      auto* stream = ctx->stream()->As<ep::MluStream>();
+      BangHandle handle(stream->mlu_stream(), stream->device()->nclusters(),
+                        stream->device()->ncores_per_cluster());
+      bang_arange_kernel<T>(handle, out->shape_view().elem_cnt(), start, delta,
+                            out->mut_dptr<T>());
     } else {
-      start_float = static_cast<float>(ctx->Attr<double>("float_start"));
-      step_float = static_cast<float>(ctx->Attr<double>("float_delta"));
-      if (cache) {
-        const auto* arange_cache = dynamic_cast<const ArangeOpKernelCache*>(cache);
-        start_int += step_int * arange_cache->lower();
+      int32_t start_int = 0;
+      int32_t step_int = 0;
+      float start_float = 0.0;
+      float step_float = 0.0;
+
+      // narrow integers are generated as int32 and cast
+      DataType tmp_out_data_type = dtype;
+      if (IsIntegralDataType(dtype)) {
+        tmp_out_data_type = DataType::kInt32;
+      } else if (dtype != DataType::kFloat16) {
+        tmp_out_data_type = DataType::kFloat;
+      }
+      CnnlTensorDescriptor tmp_out_desc;
+      tmp_out_desc.set(out, ConvertToCnnlDataType(tmp_out_data_type));
+
+      void* tmp_out_ptr = out->mut_dptr<T>();
+      CnnlWorkspace tmp_out_cnnl_workspace(ctx->stream()->As<ep::MluStream>(), 0);
+      if (tmp_out_data_type != dtype) {
+        tmp_out_cnnl_workspace.resize(out->shape_view().elem_cnt()
+                                      * GetSizeOfDataType(tmp_out_data_type));
+        tmp_out_ptr = tmp_out_cnnl_workspace.dptr();
+      }
+
+      if (IsIntegralDataType(dtype)) {
+        start_int = static_cast<int32_t>(ctx->Attr<int64_t>("integer_start"));
+        step_int = static_cast<int32_t>(ctx->Attr<int64_t>("integer_delta"));
+        start_int += step_int * static_cast<int32_t>(lower);
+        OF_CNNL_CHECK(cnnlArange_v2(ctx->stream()->As<ep::MluStream>()->cnnl_handle(),
+                                    CNNL_COMPUTATION_HIGH_PRECISION, (void*)&start_int,
+                                    (void*)&step_int, tmp_out_desc.desc(), tmp_out_ptr));
+      } else {
+        const double float_delta = ctx->Attr<double>("float_delta");
+        start_float = static_cast<float>(ctx->Attr<double>("float_start") + float_delta * lower);
+        step_float = static_cast<float>(float_delta);
+        OF_CNNL_CHECK(cnnlArange_v2(ctx->stream()->As<ep::MluStream>()->cnnl_handle(),
+                                    CNNL_COMPUTATION_HIGH_PRECISION, (void*)&start_float,
+                                    (void*)&step_float, tmp_out_desc.desc(), tmp_out_ptr));
       }
-      OF_CNNL_CHECK(cnnlArange_v2(ctx->stream()->As<ep::MluStream>()->cnnl_handle(),
-                                  CNNL_COMPUTATION_HIGH_PRECISION, (void*)&start_float,
-                                  (void*)&step_float, tmp_out_desc.desc(), tmp_out_ptr));
-    }
 
-    if (tmp_out_data_type != dtype) {
-      CnnlTensorDescriptor out_dec(out);
-      cnnlCastDataType_t type = ep::primitive::GetCnnlCastType(tmp_out_data_type, dtype);
-      OF_CNNL_CHECK(cnnlCastDataType(ctx->stream()->As<ep::MluStream>()->cnnl_handle(),
-                                     tmp_out_desc.desc(), tmp_out_ptr, type, out_dec.desc(),
-                                     out->mut_dptr<T>()));
+      if (tmp_out_data_type != dtype) {
+        CnnlTensorDescriptor out_dec(out);
+        cnnlCastDataType_t type = ep::primitive::GetCnnlCastType(tmp_out_data_type, dtype);
+        OF_CNNL_CHECK(cnnlCastDataType(ctx->stream()->As<ep::MluStream>()->cnnl_handle(),
+                                       tmp_out_desc.desc(), tmp_out_ptr, type, out_dec.desc(),
+                                       out->mut_dptr<T>()));
+      }
     }
   }
 
@@ -161,5 +181,6 @@ REGISTER_ARANGE_MLU_KERNEL(int32_t)
 REGISTER_ARANGE_MLU_KERNEL(uint32_t)
 REGISTER_ARANGE_MLU_KERNEL(int64_t)
 REGISTER_ARANGE_MLU_KERNEL(uint64_t)
+REGISTER_ARANGE_MLU_KERNEL(double)
 
 }  // namespace oneflow
@@ -18,8 +18,10 @@ limitations under the License.
 #include "oneflow_mlu/cnnl/cnnl_workspace.h"
 #include "oneflow_mlu/common/mlu_util.h"
 #include "oneflow_mlu/ep/mlu_stream.h"
+#include "oneflow_mlu/kernels/pooling_util.h"
 #include "oneflow/core/common/data_type.h"
 #include "oneflow/core/common/util.h"
+#include "oneflow/core/ep/include/primitive/broadcast_elementwise_binary.h"
 #include "oneflow/core/framework/framework.h"
 #include "oneflow/core/framework/user_op_tensor.h"
 #include "oneflow/core/kernel/new_kernel_util.h"
@@ -31,16 +33,6 @@ namespace oneflow {
 
 namespace {
 
-std::vector<int32_t> GetCnnlPadding(int32_t ndim, const std::vector<int32_t>& padding) {
-  int32_t offset = padding.size() - ndim;
-  std::vector<int32_t> cnnl_padding(ndim * 2);
-  for (int i = 0; i < ndim; ++i) {
-    cnnl_padding[2 * i] = padding[i + offset];
-    cnnl_padding[2 * i + 1] = padding[i + offset];
-  }
-  return cnnl_padding;
-}
-
 struct AvgPoolOpKernelCache final : public user_op::OpKernelCache {
   AvgPoolParams3D params_3d;
   explicit AvgPoolOpKernelCache(const AvgPoolParams3D& params_3d) : params_3d(params_3d) {}
@@ -65,6 +57,44 @@ std::shared_ptr<AvgPoolOpKernelCache> CreateAvgOpKernelCache(user_op::KernelCach
   return cache;
 }
 
+mlu::PoolingWindow3D GetAvgPoolingWindow(int32_t dim, const AvgPoolParams3D& params_3d) {
+  return mlu::MakePoolingWindow3D(dim, params_3d.pool_size_3d(), params_3d.stride_3d(),
+                                  params_3d.padding(), /*dilation=*/{}, params_3d.ceil_mode());
+}
+
+// cnnl has no divisor override, such pools average over the whole window including the padding
+// and are rescaled by ScaleByDivisorOverride afterwards.
+cnnlPoolingMode_t GetAvgPoolingMode(const AvgPoolParams3D& params_3d) {
+  return (params_3d.count_include_pad() || params_3d.divisor_override() != 0)
+             ? CNNL_POOLING_AVERAGE_COUNT_INCLUDE_PADDING
+             : CNNL_POOLING_AVERAGE_COUNT_EXCLUDE_PADDING;
+}
+
+void ScaleByDivisorOverride(ep::Stream* stream, const AvgPoolParams3D& params_3d,
+                            const mlu::PoolingWindow3D& window, user_op::Tensor* tensor) {
+  // windows clipped by ceil_mode hold less than kernel_volume elements and would need a scale
+  // per output position
+  const Shape x_shape_5d = params_3d.GetXShape5D();
+  const Shape y_shape_5d = params_3d.GetYShape5D();
+  for (int i = 0; i < 3; ++i) {
+    const int64_t window_end = (y_shape_5d.At(2 + i) - 1) * window.stride[i]
+                               - window.padding[i] + window.kernel_size[i];
+    CHECK_OR_THROW(window_end <= x_shape_5d.At(2 + i) + window.padding[i])
+        << "cambricon cnnl avg pool does not support divisor_override with windows clipped by "
+           "ceil_mode.";
+  }
+  const double scale =
+      static_cast<double>(window.kernel_volume()) / params_3d.divisor_override();
+  if (scale == 1.0) { return; }
+  const DataType data_type = tensor->data_type();
+  const int64_t num_dims = tensor->shape_view().NumAxes();
+  auto mul = ep::primitive::NewPrimitive<ep::primitive::BroadcastElementwiseBinaryFactory>(
+      DeviceType::kMLU, ep::primitive::BinaryOp::kMul, data_type, data_type, num_dims);
+  CHECK(mul);
+  mul->Launch(stream, num_dims, tensor->shape_view().ptr(), tensor->dptr(), Scalar(scale),
+              tensor->mut_dptr());
+}
+
 template<int Nd, typename T>
 class MluAvgPoolKernel final : public user_op::OpKernel {
  public:
@@ -86,47 +116,42 @@ class MluAvgPoolKernel final : public user_op::OpKernel {
 
     const auto* pool_cache = dynamic_cast<const AvgPoolOpKernelCache*>(cache);
     const AvgPoolParams3D& params_3d = pool_cache->GetParams3D();
-    CHECK_OR_THROW(params_3d.divisor_override() == 0)
-        << "cambricon cnnl avg pool does not support divisor_override.";
-
-    const std::vector<int32_t>& padding = GetCnnlPadding(Nd, params_3d.padding());
-    const std::vector<int32_t>& kernel_size = params_3d.pool_size_3d();
-    const std::vector<int32_t>& stride = params_3d.stride_3d();
-    const bool ceil_mode = params_3d.ceil_mode();
-    const std::string& data_format = params_3d.data_format();
-
-    CHECK_OR_THROW(padding.size() == Nd * 2) << "padding size should be " << Nd;
-    CHECK_OR_THROW(kernel_size.size() >= Nd) << "kernel_size size should be " << Nd;
-    CHECK_OR_THROW(stride.size() >= Nd) << "stride size should be " << Nd;
-    CHECK_OR_THROW(params_3d.divisor_override() == 0)
-        << "cambricon cnnl avg pool does not support divisor_override.";
-
-    std::vector<int32_t> dilation(Nd, 1);
-    auto cnnl_data_type = ConvertToCnnlDataType(x->data_type());
-    cnnlTensorLayout_t layout =
-        (data_format == "channels_last") ? CNNL_LAYOUT_NHWC : CNNL_LAYOUT_NCHW;
-    cnnlPoolingMode_t mode = params_3d.count_include_pad()
-                                 ? CNNL_POOLING_AVERAGE_COUNT_INCLUDE_PADDING
-                                 : CNNL_POOLING_AVERAGE_COUNT_EXCLUDE_PADDING;
+    const bool channels_last = params_3d.data_format() == "channels_last";
+    const mlu::PoolingWindow3D window = GetAvgPoolingWindow(Nd, params_3d);
+    const cnnlPoolingMode_t mode = GetAvgPoolingMode(params_3d);
+
+    const DataType data_type = x->data_type();
+    auto cnnl_data_type = ConvertToCnnlDataType(data_type);
+    Shape x_shape = mlu::GetCnnlPoolingShape(x->shape_view(), Nd, channels_last);
+    Shape y_shape = mlu::GetCnnlPoolingShape(y->shape_view(), Nd, channels_last);
+    const void* x_ptr = x->dptr();
+    void* y_ptr = y->mut_dptr();
+
+    // cnnl 3d pooling takes NDHWC tensors
+    const bool convert_format = Nd == 3 && !channels_last;
+    CnnlWorkspace temp_x(ctx->stream()->As<ep::MluStream>(), 0);
+    CnnlWorkspace temp_y(ctx->stream()->As<ep::MluStream>(), 0);
+    if (convert_format) {
+      size_t element_size = GetSizeOfDataType(data_type);
+      temp_x.resize(x_shape.elem_cnt() * element_size);
+      temp_y.resize(y_shape.elem_cnt() * element_size);
+      ConvertMemoryFormat(ctx->stream(), x_shape, data_type, x->dptr(), temp_x.dptr(),
+                          MemoryFormat::kContiguous, MemoryFormat::kChannelsLast);
+      x_shape = ComputeShapeContiguousToChannelsLast(x_shape);
+      y_shape = ComputeShapeContiguousToChannelsLast(y_shape);
+      x_ptr = temp_x.dptr();
+      y_ptr = temp_y.dptr();
+    }
+    cnnlTensorLayout_t layout = mlu::GetCnnlPoolingLayout(window, channels_last || convert_format);
     CnnlPoolingDescriptor pooling_desc;
+    mlu::SetCnnlPoolingDescriptor(&pooling_desc, mode, window);
     CnnlTensorDescriptor x_desc, y_desc;
-    x_desc.set(x->shape_view().size(), x->shape_view().data(), cnnl_data_type, layout);
-    y_desc.set(y->shape_view().size(), y->shape_view().data(), cnnl_data_type, layout);
-
-    CHECK_EQ_OR_THROW(Nd, 2) << "cnnlGetPoolingWorkspaceSize only support 2D.";
-    if (Nd == 2) {
-      pooling_desc.set(mode, kernel_size[1], kernel_size[2], stride[1], stride[2], padding[0],
-                       padding[1], padding[2], padding[3], ceil_mode);
-    } else if (Nd == 3) {
-      pooling_desc.set(mode, Nd, kernel_size.data(), stride.data(), padding.data(), dilation.data(),
-                       ceil_mode);
-    } else {
-      // TODO()
-    }
-    int h_axis = (data_format == "channels_last") ? 1 : 2;
-    int w_axis = h_axis + 1;
-    int64_t output_h = y->shape_view()[h_axis];
-    int64_t output_w = y->shape_view()[w_axis];
+    x_desc.set(x_shape.NumAxes(), x_shape.data(), cnnl_data_type, layout);
+    y_desc.set(y_shape.NumAxes(), y_shape.data(), cnnl_data_type, layout);
+
+    const Shape y_shape_5d = params_3d.GetYShape5D();
+    int64_t output_h = y_shape_5d.At(3);
+    int64_t output_w = y_shape_5d.At(4);
 
     auto handle = ctx->stream()->As<ep::MluStream>()->cnnl_handle();
     size_t pooling_workspace_size = 0;
@@ -160,26 +185,38 @@ class MluAvgPoolKernel final : public user_op::OpKernel {
         /* pooling_desc   */ pooling_desc.desc(),
         /* alpha          */ nullptr,
         /* x_desc         */ x_desc.desc(),
-        /* x              */ x->dptr(),
+        /* x              */ x_ptr,
         /* beta           */ nullptr,
         /* extra_input    */ extra_device_input_dptr,
         /* y_desc         */ y_desc.desc(),
-        /* y              */ y->mut_dptr(),
+        /* y              */ y_ptr,
         /* workspace      */ pooling_workspace.dptr(),
         /* workspace_size */ pooling_workspace_size));
+
+    if (convert_format) {
+      ConvertMemoryFormat(ctx->stream(), y_shape, data_type, y_ptr, y->mut_dptr(),
+                          MemoryFormat::kChannelsLast, MemoryFormat::kContiguous);
+    }
+    if (params_3d.divisor_override() != 0) {
+      ScaleByDivisorOverride(ctx->stream(), params_3d, window, y);
+    }
   }
 
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
 
-#define REGISTER_MLU_AVG_POOL_KERNEL(dtype)                           \
-  REGISTER_USER_KERNEL("avg_pool_2d")                                 \
-      .SetCreateFn<MluAvgPoolKernel<2, dtype>>()                      \
+#define REGISTER_MLU_AVG_POOL_KERNEL(dim, dtype)                      \
+  REGISTER_USER_KERNEL("avg_pool_" #dim "d")                          \
+      .SetCreateFn<MluAvgPoolKernel<dim, dtype>>()                    \
       .SetIsMatchedHob((user_op::HobDeviceType() == DeviceType::kMLU) \
                        && (user_op::HobDataType("x", 0) == GetDataType<dtype>::value));
 
-REGISTER_MLU_AVG_POOL_KERNEL(float)
-REGISTER_MLU_AVG_POOL_KERNEL(float16)
+REGISTER_MLU_AVG_POOL_KERNEL(1, float)
+REGISTER_MLU_AVG_POOL_KERNEL(1, float16)
+REGISTER_MLU_AVG_POOL_KERNEL(2, float)
+REGISTER_MLU_AVG_POOL_KERNEL(2, float16)
+REGISTER_MLU_AVG_POOL_KERNEL(3, float)
+REGISTER_MLU_AVG_POOL_KERNEL(3, float16)
 
 #undef REGISTER_MLU_AVG_POOL_KERNEL
 
@@ -204,37 +241,17 @@ class MluAvgPoolGradKernel final : public user_op::OpKernel {
 
     const auto* pool_cache = dynamic_cast<const AvgPoolOpKernelCache*>(cache);
     const AvgPoolParams3D& params_3d = pool_cache->GetParams3D();
+    const bool channels_last = params_3d.data_format() == "channels_last";
+    const mlu::PoolingWindow3D window = GetAvgPoolingWindow(Nd, params_3d);
+    const cnnlPoolingMode_t mode = GetAvgPoolingMode(params_3d);
 
-    const std::vector<int32_t>& padding = GetCnnlPadding(Nd, params_3d.padding());
-    const std::vector<int32_t>& kernel_size = params_3d.pool_size_3d();
-    const std::vector<int32_t>& stride = params_3d.stride_3d();
-    const bool ceil_mode = params_3d.ceil_mode();
-
-    CHECK_OR_THROW(padding.size() == Nd * 2) << "padding size should be " << Nd;
-    CHECK_OR_THROW(kernel_size.size() >= Nd) << "kernel_size size should be " << Nd;
-    CHECK_OR_THROW(stride.size() >= Nd) << "stride size should be " << Nd;
-    CHECK_OR_THROW(params_3d.divisor_override() == 0)
-        << "cambricon cnnl avg pool does not support divisor_override.";
-
-    std::vector<int32_t> dilation(Nd, 1);
-    cnnlPoolingMode_t mode = params_3d.count_include_pad()
-                                 ? CNNL_POOLING_AVERAGE_COUNT_INCLUDE_PADDING
-                                 : CNNL_POOLING_AVERAGE_COUNT_EXCLUDE_PADDING;
     auto data_type = x->data_type();
     auto cnnl_data_type = ConvertToCnnlDataType(data_type);
     CnnlTensorDescriptor x_desc, dy_desc, dx_desc;
     CnnlPoolingDescriptor pooling_desc;
-    if (Nd == 2) {
-      pooling_desc.set(mode, kernel_size[1], kernel_size[2], stride[1], stride[2], padding[0],
-                       padding[1], padding[2], padding[3], ceil_mode);
-    } else if (Nd == 3) {
-      pooling_desc.set(mode, Nd, kernel_size.data(), stride.data(), padding.data(), dilation.data(),
-                       ceil_mode);
-    } else {
-      // TODO()
-    }
-    auto shape = Shape(x->shape_view());
-    auto dy_shape = Shape(dy->shape_view());
+    mlu::SetCnnlPoolingDescriptor(&pooling_desc, mode, window);
+    auto shape = mlu::GetCnnlPoolingShape(x->shape_view(), Nd, channels_last);
+    auto dy_shape = mlu::GetCnnlPoolingShape(dy->shape_view(), Nd, channels_last);
     const void* x_ptr = x->dptr();
     const void* dy_ptr = dy->dptr();
     void* dx_ptr = dx->mut_dptr();
@@ -243,48 +260,56 @@ class MluAvgPoolGradKernel final : public user_op::OpKernel {
     CnnlWorkspace temp_dy(ctx->stream()->As<ep::MluStream>(), 0);
     CnnlWorkspace temp_dx(ctx->stream()->As<ep::MluStream>(), 0);
 
-    if (params_3d.data_format() != "channels_last") {
+    if (!channels_last) {
       size_t element_size = GetSizeOfDataType(data_type);
-      shape = ComputeShapeContiguousToChannelsLast(shape);
-      dy_shape = ComputeShapeContiguousToChannelsLast(dy_shape);
       temp_x.resize(shape.elem_cnt() * element_size);
       temp_dy.resize(dy_shape.elem_cnt() * element_size);
       temp_dx.resize(shape.elem_cnt() * element_size);
       // convert x to NHWC
-      ConvertMemoryFormat(ctx->stream(), x->shape_view(), data_type, x->dptr(), temp_x.dptr(),
+      ConvertMemoryFormat(ctx->stream(), shape, data_type, x->dptr(), temp_x.dptr(),
                           MemoryFormat::kContiguous, MemoryFormat::kChannelsLast);
       // convert dy to NHWC
-      ConvertMemoryFormat(ctx->stream(), dy->shape_view(), data_type, dy->dptr(), temp_dy.dptr(),
+      ConvertMemoryFormat(ctx->stream(), dy_shape, data_type, dy->dptr(), temp_dy.dptr(),
                           MemoryFormat::kContiguous, MemoryFormat::kChannelsLast);
+      shape = ComputeShapeContiguousToChannelsLast(shape);
+      dy_shape = ComputeShapeContiguousToChannelsLast(dy_shape);
       x_ptr = temp_x.dptr();
       dy_ptr = temp_dy.dptr();
       dx_ptr = temp_dx.dptr();
     }
-    x_desc.set(shape.NumAxes(), shape.data(), cnnl_data_type, CNNL_LAYOUT_NHWC);
-    dy_desc.set(dy_shape.NumAxes(), dy_shape.data(), cnnl_data_type, CNNL_LAYOUT_NHWC);
-    dx_desc.set(shape.NumAxes(), shape.data(), cnnl_data_type, CNNL_LAYOUT_NHWC);
+    cnnlTensorLayout_t layout = mlu::GetCnnlPoolingLayout(window, /*channels_last=*/true);
+    x_desc.set(shape.NumAxes(), shape.data(), cnnl_data_type, layout);
+    dy_desc.set(dy_shape.NumAxes(), dy_shape.data(), cnnl_data_type, layout);
+    dx_desc.set(shape.NumAxes(), shape.data(), cnnl_data_type, layout);
 
     auto handle = ctx->stream()->As<ep::MluStream>()->cnnl_handle();
     OF_CNNL_CHECK(cnnlPoolingBackward(handle, pooling_desc.desc(), nullptr, /*y_desc*/ nullptr,
                                       /*y*/ nullptr, dy_desc.desc(), dy_ptr, x_desc.desc(), x_ptr,
                                       nullptr, dx_desc.desc(), dx_ptr));
 
-    if (params_3d.data_format() != "channels_last") {
+    if (!channels_last) {
       // convert dx to NCHW
       ConvertMemoryFormat(ctx->stream(), shape, data_type, dx_ptr, dx->mut_dptr(),
                           MemoryFormat::kChannelsLast, MemoryFormat::kContiguous);
     }
+    if (params_3d.divisor_override() != 0) {
+      ScaleByDivisorOverride(ctx->stream(), params_3d, window, dx);
+    }
   }
 };
 
-#define REGISTER_MLU_AVG_POOL_GRAD_KERNEL(dtype)                      \
-  REGISTER_USER_KERNEL("avg_pool_2d_grad")                            \
-      .SetCreateFn<MluAvgPoolGradKernel<2, dtype>>()                  \
+#define REGISTER_MLU_AVG_POOL_GRAD_KERNEL(dim, dtype)                 \
+  REGISTER_USER_KERNEL("avg_pool_" #dim "d_grad")                     \
+      .SetCreateFn<MluAvgPoolGradKernel<dim, dtype>>()                \
       .SetIsMatchedHob((user_op::HobDeviceType() == DeviceType::kMLU) \
                        && (user_op::HobDataType("x", 0) == GetDataType<dtype>::value));
 
-REGISTER_MLU_AVG_POOL_GRAD_KERNEL(float)
-REGISTER_MLU_AVG_POOL_GRAD_KERNEL(float16)
+REGISTER_MLU_AVG_POOL_GRAD_KERNEL(1, float)
+REGISTER_MLU_AVG_POOL_GRAD_KERNEL(1, float16)
+REGISTER_MLU_AVG_POOL_GRAD_KERNEL(2, float)
+REGISTER_MLU_AVG_POOL_GRAD_KERNEL(2, float16)
+REGISTER_MLU_AVG_POOL_GRAD_KERNEL(3, float)
+REGISTER_MLU_AVG_POOL_GRAD_KERNEL(3, float16)
 
 #undef REGISTER_MLU_AVG_POOL_GRAD_KERNEL
 
@@ -13,6 +13,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 */
+#include "oneflow_mlu/bang/bang_kernels.h"
 #include "oneflow_mlu/ep/mlu_stream.h"
 #include "oneflow_mlu/common/mlu_util.h"
 #include "oneflow/core/common/data_type.h"
@@ -23,11 +24,36 @@ limitations under the License.
 
 namespace oneflow {
 
-template<typename T>
-class MluClipByScalarMaxKernel final : public user_op::OpKernel {
+namespace {
+
+// Host values of one bound as cnnlClip_v2 expects them: int32 for int32 tensors, float for
+// floating tensors.
+struct ClipBound {
+  float floating;
+  int32_t integral;
+
+  const void* ptr(DataType data_type) const {
+    return data_type == DataType::kInt32 ? static_cast<const void*>(&integral)
+                                         : static_cast<const void*>(&floating);
+  }
+};
+
+ClipBound GetClipBound(user_op::KernelComputeContext* ctx, const std::string& floating_attr,
+                       const std::string& integral_attr) {
+  return ClipBound{static_cast<float>(ctx->Attr<double>(floating_attr)),
+                   static_cast<int32_t>(ctx->Attr<int64_t>(integral_attr))};
+}
+
+}  // namespace
+
+// clip_by_scalar, clip_by_scalar_min and clip_by_scalar_max are all one cnnlClip_v2 call with the
+// missing bound left null. cnnlClip_v2 is elementwise, so the in-place clamp_ where y aliases x
+// also reads and writes memory once.
+template<typename T, bool has_min, bool has_max>
+class MluClipByScalarKernel final : public user_op::OpKernel {
  public:
-  MluClipByScalarMaxKernel() = default;
-  ~MluClipByScalarMaxKernel() = default;
+  MluClipByScalarKernel() = default;
+  ~MluClipByScalarKernel() = default;
 
  private:
   using user_op::OpKernel::Compute;
@@ -35,35 +61,85 @@ class MluClipByScalarMaxKernel final : public user_op::OpKernel {
   void Compute(user_op::KernelComputeContext* ctx) const override {
     const user_op::Tensor* x = ctx->Tensor4ArgNameAndIndex("x", 0);
     user_op::Tensor* y = ctx->Tensor4ArgNameAndIndex("y", 0);
-    float floating_max = static_cast<float>(ctx->Attr<double>("floating_max"));
-    int32_t integral_max = static_cast<int32_t>(ctx->Attr<int64_t>("integral_max"));
+    ClipBound min_bound{}, max_bound{};
+    if (has_min) { min_bound = GetClipBound(ctx, "floating_min", "integral_min"); }
+    if (has_max) { max_bound = GetClipBound(ctx, "floating_max", "integral_max"); }
     CnnlTensorDescriptor input_desc, output_desc;
     input_desc.set(x);
     output_desc.set(y);
-    void* max = nullptr;
-    if (x->data_type() == DataType::kInt32) {
-      max = &integral_max;
-    } else {
-      max = &floating_max;
-    }
     OF_CNNL_CHECK(cnnlClip_v2(ctx->stream()->As<ep::MluStream>()->cnnl_handle(),
-                              CNNL_POINTER_MODE_HOST, input_desc.desc(), x->dptr(), nullptr, max,
+                              CNNL_POINTER_MODE_HOST, input_desc.desc(), x->dptr(),
+                              has_min ? min_bound.ptr(x->data_type()) : nullptr,
+                              has_max ? max_bound.ptr(x->data_type()) : nullptr,
                               output_desc.desc(), y->mut_dptr()));
   }
 
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
 
-#define REGISTER_CLIP_BY_VALUE_MLU_KERNEL(op_type_name, kernel_name, dtype) \
-  REGISTER_USER_KERNEL(op_type_name)                                        \
-      .SetCreateFn<kernel_name##Kernel<dtype>>()                            \
-      .SetIsMatchedHob((user_op::HobDeviceType() == DeviceType::kMLU)       \
+// The gradients pass dy through where x lies inside the bounds in a single BANG launch, a
+// missing bound is treated as infinite.
+template<typename T, bool has_min, bool has_max>
+class MluClipByScalarGradKernel final : public user_op::OpKernel {
+ public:
+  MluClipByScalarGradKernel() = default;
+  ~MluClipByScalarGradKernel() = default;
+
+ private:
+  using user_op::OpKernel::Compute;
+
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* dy = ctx->Tensor4ArgNameAndIndex("dy", 0);
+    const user_op::Tensor* x = ctx->Tensor4ArgNameAndIndex("x", 0);
+    user_op::Tensor* dx = ctx->Tensor4ArgNameAndIndex("dx", 0);
+    const float min_value = has_min ? static_cast<float>(ctx->Attr<double>("floating_min"))
+                                    : -std::numeric_limits<float>::infinity();
+    const float max_value = has_max ? static_cast<float>(ctx->Attr<double>("floating_max"))
+                                    : std::numeric_limits<float>::infinity();
+    const int64_t n = x->shape_view().elem_cnt();
+
+    auto* stream = ctx->stream()->As<ep::MluStream>();
+    BangHandle handle(stream->mlu_stream(), stream->device()->nclusters(),
+                      stream->device()->ncores_per_cluster());
+    if constexpr (std::is_same<T, float16>::value) {
+      bang_clip_by_scalar_grad_half_kernel(handle, n, min_value, max_value, x->dptr(), dy->dptr(),
+                                           dx->mut_dptr());
+    } else {
+      bang_clip_by_scalar_grad_kernel(handle, n, min_value, max_value, x->dptr<T>(),
+                                      dy->dptr<T>(), dx->mut_dptr<T>());
+    }
+  }
+
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+#define REGISTER_CLIP_BY_VALUE_MLU_KERNEL(op_type_name, kernel_name, dtype, has_min, has_max) \
+  REGISTER_USER_KERNEL(op_type_name)                                                          \
+      .SetCreateFn<kernel_name##Kernel<dtype, has_min, has_max>>()                            \
+      .SetIsMatchedHob((user_op::HobDeviceType() == DeviceType::kMLU)                         \
                        && (user_op::HobDataType("x", 0) == GetDataType<dtype>::value));
 
-REGISTER_CLIP_BY_VALUE_MLU_KERNEL("clip_by_scalar_max", MluClipByScalarMax, float)
-REGISTER_CLIP_BY_VALUE_MLU_KERNEL("clip_by_scalar_max", MluClipByScalarMax, float16)
-REGISTER_CLIP_BY_VALUE_MLU_KERNEL("clip_by_scalar_max", MluClipByScalarMax, int32_t)
+#define REGISTER_CLIP_BY_SCALAR_MLU_KERNELS(dtype)                                             \
+  REGISTER_CLIP_BY_VALUE_MLU_KERNEL("clip_by_scalar", MluClipByScalar, dtype, true, true)      \
+  REGISTER_CLIP_BY_VALUE_MLU_KERNEL("clip_by_scalar_min", MluClipByScalar, dtype, true, false) \
+  REGISTER_CLIP_BY_VALUE_MLU_KERNEL("clip_by_scalar_max", MluClipByScalar, dtype, false, true)
+
+#define REGISTER_CLIP_BY_SCALAR_GRAD_MLU_KERNELS(dtype)                                          \
+  REGISTER_CLIP_BY_VALUE_MLU_KERNEL("clip_by_scalar_grad", MluClipByScalarGrad, dtype, true,     \
+                                    true)                                                        \
+  REGISTER_CLIP_BY_VALUE_MLU_KERNEL("clip_by_scalar_min_grad", MluClipByScalarGrad, dtype, true, \
+                                    false)                                                       \
+  REGISTER_CLIP_BY_VALUE_MLU_KERNEL("clip_by_scalar_max_grad", MluClipByScalarGrad, dtype,       \
+                                    false, true)
+
+REGISTER_CLIP_BY_SCALAR_MLU_KERNELS(float)
+REGISTER_CLIP_BY_SCALAR_MLU_KERNELS(float16)
+REGISTER_CLIP_BY_SCALAR_MLU_KERNELS(int32_t)
+REGISTER_CLIP_BY_SCALAR_GRAD_MLU_KERNELS(float)
+REGISTER_CLIP_BY_SCALAR_GRAD_MLU_KERNELS(float16)
 
+#undef REGISTER_CLIP_BY_SCALAR_GRAD_MLU_KERNELS
+#undef REGISTER_CLIP_BY_SCALAR_MLU_KERNELS
 #undef REGISTER_CLIP_BY_VALUE_MLU_KERNEL
 
 }  // namespace oneflow
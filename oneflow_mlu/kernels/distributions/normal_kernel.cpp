@@ -13,7 +13,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 */
-#include "oneflow_mlu/cnnl/cnnl_types.h"
+#include "oneflow_mlu/bang/bang_kernels.h"
 #include "oneflow_mlu/ep/mlu_random_generator.h"
 #include "oneflow_mlu/ep/mlu_stream.h"
 #include "oneflow/core/framework/framework.h"
@@ -52,14 +52,17 @@ class MluNormalKernel final : public user_op::OpKernel {
         CHECK_JUST(distribution_state->generator()->Get<ep::MLUGenerator>());
     CHECK_NOTNULL(generator);
 
-    auto cnnl_handle = ctx->stream()->As<ep::MluStream>()->cnnl_handle();
-    // update generator state
-    if (generator->need_update_state()) { generator->update_state(cnnl_handle); }
-
-    cnnlDataType_t cnnl_dtype = ConvertToCnnlDataType(GetDataType<T>::value);
-    OF_CNNL_CHECK(cnnlRandGenerateNormal(cnnl_handle, generator->cnnl_rng(), cnnl_dtype,
-                                         generator->state(), out->shape_view().elem_cnt(), mean,
-                                         std, out->mut_dptr()));
+    auto* stream = ctx->stream()->As<ep::MluStream>();
+    BangHandle handle(stream->mlu_stream(), stream->device()->nclusters(),
+                      stream->device()->ncores_per_cluster());
+    const int64_t elem_cnt = out->shape_view().elem_cnt();
+    const uint64_t seed = generator->current_seed();
+    const uint64_t offset = generator->get_philox_offset(1);
+    if constexpr (std::is_same<T, float16>::value) {
+      bang_philox_normal_half_kernel(handle, elem_cnt, seed, offset, mean, std, out->mut_dptr());
+    } else {
+      bang_philox_normal_kernel<T>(handle, elem_cnt, seed, offset, mean, std, out->mut_dptr<T>());
+    }
   }
 
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
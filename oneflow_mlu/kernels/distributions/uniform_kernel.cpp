@@ -0,0 +1,80 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow_mlu/bang/bang_kernels.h"
+#include "oneflow_mlu/ep/mlu_random_generator.h"
+#include "oneflow_mlu/ep/mlu_stream.h"
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/user/kernels/distributions/common.h"
+#include "oneflow/user/kernels/random_seed_util.h"
+
+namespace oneflow {
+
+namespace {
+
+template<typename T>
+class MluUniformKernel final : public user_op::OpKernel {
+ public:
+  MluUniformKernel() = default;
+  ~MluUniformKernel() = default;
+
+  std::shared_ptr<user_op::OpKernelState> CreateOpKernelState(
+      user_op::KernelInitContext* ctx) const override {
+    const auto& generator = CHECK_JUST(one::MakeGenerator(DeviceType::kMLU));
+    // When SBP is Split, each rank uses a different seeds, otherwise, ranks use the same seed
+    generator->set_current_seed(
+        CHECK_JUST(GetOpKernelRandomSeedInCurrentRank(ctx, ctx->Attr<int64_t>("seed"))));
+    return std::make_shared<DistributionKernelState>(generator);
+  }
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx, user_op::OpKernelState* state,
+               const user_op::OpKernelCache*) const override {
+    user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    const double from = ctx->Attr<double>("from");
+    const double to = ctx->Attr<double>("to");
+
+    auto* distribution_state = dynamic_cast<DistributionKernelState*>(state);
+    CHECK_NOTNULL(distribution_state);
+    std::shared_ptr<ep::MLUGenerator> generator =
+        CHECK_JUST(distribution_state->generator()->Get<ep::MLUGenerator>());
+    CHECK_NOTNULL(generator);
+
+    auto* stream = ctx->stream()->As<ep::MluStream>();
+    BangHandle handle(stream->mlu_stream(), stream->device()->nclusters(),
+                      stream->device()->ncores_per_cluster());
+    const int64_t elem_cnt = out->shape_view().elem_cnt();
+    const uint64_t seed = generator->current_seed();
+    const uint64_t offset = generator->get_philox_offset(1);
+    if constexpr (std::is_same<T, float16>::value) {
+      bang_philox_uniform_half_kernel(handle, elem_cnt, seed, offset, from, to, out->mut_dptr());
+    } else {
+      bang_philox_uniform_kernel<T>(handle, elem_cnt, seed, offset, from, to, out->mut_dptr<T>());
+    }
+  }
+
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+#define REGISTER_MLU_UNIFORM_KERNEL(dtype)                                                \
+  REGISTER_USER_KERNEL("uniform").SetCreateFn<MluUniformKernel<dtype>>().SetIsMatchedHob( \
+      (user_op::HobDeviceType() == DeviceType::kMLU)                                      \
+      && (user_op::HobAttr<DataType>("dtype") == GetDataType<dtype>::value));
+
+REGISTER_MLU_UNIFORM_KERNEL(float16)
+REGISTER_MLU_UNIFORM_KERNEL(float)
+
+}  // namespace
+}  // namespace oneflow
@@ -13,6 +13,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 */
+#include "oneflow_mlu/bang/bang_kernels.h"
 #include "oneflow_mlu/cnnl/cnnl_tensor_descriptor.h"
 #include "oneflow_mlu/cnnl/cnnl_workspace.h"
 #include "oneflow_mlu/ep/mlu_random_generator.h"
@@ -46,20 +47,24 @@ class MluDropoutKernel final : public user_op::OpKernel {
     user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
     const float rate = ctx->Attr<float>("rate");
 
-    CnnlTensorDescriptor in_desc(in), out_desc(out);
-    CnnlTensorDescriptor mask_desc(mask, CNNL_DTYPE_UINT8);
-
     auto* dropout_kernel_state = dynamic_cast<FusedDropoutKernelState*>(state);
     CHECK_NOTNULL(dropout_kernel_state);
     std::shared_ptr<ep::MLUGenerator> generator =
         CHECK_JUST(dropout_kernel_state->generator()->Get<ep::MLUGenerator>());
 
-    auto cnnl_handle = ctx->stream()->As<ep::MluStream>()->cnnl_handle();
-    // update generator state
-    if (generator->need_update_state()) { generator->update_state(cnnl_handle); }
-    OF_CNNL_CHECK(cnnlFusedDropout_v2(cnnl_handle, generator->cnnl_rng(), in_desc.desc(),
-                                      in->dptr(), rate, generator->state(), mask_desc.desc(),
-                                      mask->mut_dptr(), out_desc.desc(), out->mut_dptr()));
+    auto* stream = ctx->stream()->As<ep::MluStream>();
+    BangHandle handle(stream->mlu_stream(), stream->device()->nclusters(),
+                      stream->device()->ncores_per_cluster());
+    const int64_t elem_cnt = in->shape_view().elem_cnt();
+    const uint64_t seed = generator->current_seed();
+    const uint64_t offset = generator->get_philox_offset(1);
+    if constexpr (std::is_same<T, float16>::value) {
+      bang_philox_dropout_half_kernel(handle, elem_cnt, seed, offset, rate, in->dptr(),
+                                      mask->mut_dptr<bool>(), out->mut_dptr());
+    } else {
+      bang_philox_dropout_kernel<T>(handle, elem_cnt, seed, offset, rate, in->dptr<T>(),
+                                    mask->mut_dptr<bool>(), out->mut_dptr<T>());
+    }
 
     if (ctx->has_input("_add_to_output", 0)) {
       const user_op::Tensor* add_to_output = ctx->Tensor4ArgNameAndIndex("_add_to_output", 0);
@@ -0,0 +1,86 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow_mlu/cnnl/cnnl_workspace.h"
+#include "oneflow_mlu/bang/bang_kernels.h"
+#include "oneflow_mlu/common/mlu_util.h"
+#include "oneflow_mlu/ep/mlu_stream.h"
+#include "oneflow/core/framework/framework.h"
+
+namespace oneflow {
+namespace {
+
+template<typename T>
+class MluFusedClipGradKernel final : public user_op::OpKernel {
+ public:
+  MluFusedClipGradKernel() = default;
+  ~MluFusedClipGradKernel() override = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx, user_op::OpKernelState*,
+               const user_op::OpKernelCache*) const override {
+    user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    size_t input_num = ctx->input_size("model_diff");
+    std::vector<T*> model_diffs(input_num);
+    std::vector<int64_t> sizes(input_num);
+    for (size_t i = 0; i < input_num; ++i) {
+      user_op::Tensor* model_diff = ctx->Tensor4ArgNameAndIndex("model_diff", i);
+      model_diffs[i] = model_diff->mut_dptr<T>();
+      sizes[i] = model_diff->shape_view().elem_cnt();
+    }
+    const float max_norm = ctx->Attr<float>("max_norm");
+    const float norm_type = ctx->Attr<float>("norm_type");
+    auto* stream = ctx->stream()->As<ep::MluStream>();
+    BangHandle handle(stream->mlu_stream(), stream->device()->nclusters(),
+                      stream->device()->ncores_per_cluster());
+    CnnlWorkspace workspace(stream, bang_multi_tensor_norm_workspace_size(handle));
+
+    // the norm and the clip coefficient come from a single read of the gradients, the second
+    // launch only rescales them and returns early on device when no clipping is needed
+    if constexpr (std::is_same<T, float16>::value) {
+      bang_multi_tensor_norm_half_kernel(
+          handle, input_num, reinterpret_cast<const void**>(model_diffs.data()), sizes.data(),
+          norm_type, /*take_root=*/true, out->mut_dptr(), /*not_finite=*/nullptr, /*clip=*/true,
+          max_norm, workspace.dptr());
+      bang_multi_tensor_clip_half_kernel(handle, input_num,
+                                         reinterpret_cast<void**>(model_diffs.data()),
+                                         sizes.data(), workspace.dptr());
+    } else {
+      bang_multi_tensor_norm_kernel<T>(handle, input_num,
+                                       const_cast<const T**>(model_diffs.data()), sizes.data(),
+                                       norm_type, /*take_root=*/true, out->mut_dptr<T>(),
+                                       /*not_finite=*/nullptr, /*clip=*/true, max_norm,
+                                       workspace.dptr());
+      bang_multi_tensor_clip_kernel<T>(handle, input_num, model_diffs.data(), sizes.data(),
+                                       workspace.dptr());
+    }
+  }
+
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+#define REGISTER_MLU_FUSED_CLIP_GRAD_KERNEL(dtype)                    \
+  REGISTER_USER_KERNEL("fused_clip_grad")                             \
+      .SetCreateFn<MluFusedClipGradKernel<dtype>>()                   \
+      .SetIsMatchedHob((user_op::HobDeviceType() == DeviceType::kMLU) \
+                       && (user_op::HobDataType("out", 0) == GetDataType<dtype>::value));
+
+REGISTER_MLU_FUSED_CLIP_GRAD_KERNEL(float)
+REGISTER_MLU_FUSED_CLIP_GRAD_KERNEL(float16)
+
+#undef REGISTER_MLU_FUSED_CLIP_GRAD_KERNEL
+
+}  // namespace
+}  // namespace oneflow
@@ -18,6 +18,7 @@ limitations under the License.
 #include "oneflow_mlu/cnnl/cnnl_workspace.h"
 #include "oneflow_mlu/common/mlu_util.h"
 #include "oneflow_mlu/ep/mlu_stream.h"
+#include "oneflow_mlu/kernels/pooling_util.h"
 #include "oneflow/core/common/data_type.h"
 #include "oneflow/core/common/data_type.pb.h"
 #include "oneflow/core/common/util.h"
@@ -29,6 +30,21 @@ limitations under the License.
 
 namespace oneflow {
 
+namespace {
+
+mlu::PoolingWindow3D GetMaxPoolingWindow(user_op::KernelComputeContext* ctx, int32_t dim) {
+  const std::vector<int32_t>& dilation = ctx->Attr<std::vector<int32_t>>("dilation");
+  for (int32_t d : dilation) {
+    CHECK_OR_THROW(d == 1) << "cambricon cnnl max pool only supports dilation 1.";
+  }
+  return mlu::MakePoolingWindow3D(dim, ctx->Attr<std::vector<int32_t>>("kernel_size"),
+                                  ctx->Attr<std::vector<int32_t>>("stride"),
+                                  ctx->Attr<std::vector<int32_t>>("padding"), dilation,
+                                  ctx->Attr<bool>("ceil_mode"));
+}
+
+}  // namespace
+
 template<int Nd, typename T>
 class MluMaxPoolKernel final : public user_op::OpKernel {
  public:
@@ -43,53 +59,51 @@ class MluMaxPoolKernel final : public user_op::OpKernel {
     user_op::Tensor* y = ctx->Tensor4ArgNameAndIndex("y", 0);
     user_op::Tensor* indice = ctx->Tensor4ArgNameAndIndex("indice", 0);
 
-    const std::vector<int32_t>& padding = ctx->Attr<std::vector<int32_t>>("padding");
-    const std::vector<int32_t>& kernel_size = ctx->Attr<std::vector<int32_t>>("kernel_size");
-    const std::vector<int32_t>& stride = ctx->Attr<std::vector<int32_t>>("stride");
-    const std::vector<int32_t>& dilation = ctx->Attr<std::vector<int32_t>>("dilation");
-    const bool ceil_mode = ctx->Attr<bool>("ceil_mode");
     const std::string& data_format = ctx->Attr<std::string>("data_format");
-
-    CHECK_OR_THROW(padding.size() == 2) << "padding size should be 2.";
-    CHECK_OR_THROW(kernel_size.size() == 2) << "kernel_size size should be 2.";
-    CHECK_OR_THROW(stride.size() == 2) << "stride size should be 2.";
-    CHECK_OR_THROW(dilation.size() == 2) << "dilation size should be 2.";
-    CHECK_OR_THROW(dilation[0] == 1 && dilation[1] == 1)
-        << "cambricon cnnl max pool only supports dilation 1.";
+    const bool channels_last = data_format == "channels_last";
+    const mlu::PoolingWindow3D window = GetMaxPoolingWindow(ctx, Nd);
 
     const DataType data_type = x->data_type();
     auto cnnl_data_type = ConvertToCnnlDataType(data_type);
-    cnnlTensorLayout_t layout =
-        (data_format == "channels_last") ? CNNL_LAYOUT_NHWC : CNNL_LAYOUT_NCHW;
-    cnnlPoolingMode_t mode = CNNL_POOLING_MAX;
-    CnnlPoolingDescriptor pooling_desc;
-    CnnlTensorDescriptor x_desc, y_desc, indice_desc;
-    x_desc.set(x->shape_view().size(), x->shape_view().data(), cnnl_data_type, layout);
-    y_desc.set(y->shape_view().size(), y->shape_view().data(), cnnl_data_type, layout);
-    indice_desc.set(indice->shape_view().size(), indice->shape_view().data(),
-                    ConvertToCnnlDataType(indice->data_type()), layout);
-
-    // cnnlPoolingForwardWithIndex requires index_desc->dtype == CNNL_DTYPE_INT32 or
-    // CNNL_DTYPE_INT16 But in oneflow/user/ops/max_pool_op.cpp its dtype is set as kInt64.
-    // cnnlPoolingForwardWithIndex requires index dtype is int32 for float input,
-    // and index dtype is int16 for half input
-    auto local_index_dtype = CNNL_DTYPE_INVALID;
-    CnnlWorkspace local_index(ctx->stream()->As<ep::MluStream>());
-    if (GetDataType<T>::value == DataType::kFloat) {
-      local_index_dtype = ConvertToCnnlDataType(kInt32);
-      local_index.resize(sizeof(int32_t) * indice->shape_view().elem_cnt());
-    } else if (GetDataType<T>::value == DataType::kFloat16) {
-      local_index_dtype = ConvertToCnnlDataType(kInt16);
-      local_index.resize(sizeof(int16_t) * indice->shape_view().elem_cnt() * 3);
+    Shape x_shape = mlu::GetCnnlPoolingShape(x->shape_view(), Nd, channels_last);
+    Shape y_shape = mlu::GetCnnlPoolingShape(y->shape_view(), Nd, channels_last);
+    const void* x_ptr = x->dptr();
+    void* y_ptr = y->mut_dptr();
+
+    // the window local index is computed in its native width and widened to the int64 indice
+    // in a single pass
+    const DataType local_index_data_type = mlu::GetPoolingLocalIndexDataType(data_type);
+    const int64_t index_elem_cnt = indice->shape_view().elem_cnt();
+    const size_t local_index_size = index_elem_cnt * GetSizeOfDataType(local_index_data_type);
+    CnnlWorkspace local_index(ctx->stream()->As<ep::MluStream>(), local_index_size);
+    void* local_index_ptr = local_index.dptr();
+
+    // cnnl 3d pooling takes NDHWC tensors
+    const bool convert_format = Nd == 3 && !channels_last;
+    CnnlWorkspace temp_x(ctx->stream()->As<ep::MluStream>(), 0);
+    CnnlWorkspace temp_y(ctx->stream()->As<ep::MluStream>(), 0);
+    CnnlWorkspace temp_local_index(ctx->stream()->As<ep::MluStream>(), 0);
+    if (convert_format) {
+      size_t element_size = GetSizeOfDataType(data_type);
+      temp_x.resize(x_shape.elem_cnt() * element_size);
+      temp_y.resize(y_shape.elem_cnt() * element_size);
+      temp_local_index.resize(local_index_size);
+      ConvertMemoryFormat(ctx->stream(), x_shape, data_type, x->dptr(), temp_x.dptr(),
+                          MemoryFormat::kContiguous, MemoryFormat::kChannelsLast);
+      x_shape = ComputeShapeContiguousToChannelsLast(x_shape);
+      y_shape = ComputeShapeContiguousToChannelsLast(y_shape);
+      x_ptr = temp_x.dptr();
+      y_ptr = temp_y.dptr();
+      local_index_ptr = temp_local_index.dptr();
     }
-    CnnlTensorDescriptor local_index_desc;
-    local_index_desc.set(indice->shape_view().NumAxes(), indice->shape_view().data(),
-                         local_index_dtype, layout);
-
-    // calculate paddings
-    int pu = padding[0], pd = padding[0], pl = padding[1], pr = padding[1];
-    pooling_desc.set(mode, kernel_size[0], kernel_size[1], stride[0], stride[1], pu, pd, pl, pr,
-                     ceil_mode);
+    cnnlTensorLayout_t layout = mlu::GetCnnlPoolingLayout(window, channels_last || convert_format);
+    CnnlPoolingDescriptor pooling_desc;
+    mlu::SetCnnlPoolingDescriptor(&pooling_desc, CNNL_POOLING_MAX, window);
+    CnnlTensorDescriptor x_desc, y_desc, local_index_desc;
+    x_desc.set(x_shape.NumAxes(), x_shape.data(), cnnl_data_type, layout);
+    y_desc.set(y_shape.NumAxes(), y_shape.data(), cnnl_data_type, layout);
+    local_index_desc.set(y_shape.NumAxes(), y_shape.data(),
+                         ConvertToCnnlDataType(local_index_data_type), layout);
 
     size_t pooling_workspace_size = 0;
     OF_CNNL_CHECK(cnnlGetPoolingWithIndexWorkspaceSize(
@@ -104,43 +118,43 @@ class MluMaxPoolKernel final : public user_op::OpKernel {
         /* pooling_desc   */ pooling_desc.desc(),
         /* alpha          */ nullptr,
         /* x_desc         */ x_desc.desc(),
-        /* x              */ x->dptr(),
+        /* x              */ x_ptr,
         /* beta           */ nullptr,
         /* y_desc         */ y_desc.desc(),
-        /* y              */ y->mut_dptr(),
+        /* y              */ y_ptr,
         /* index_desc     */ local_index_desc.desc(),
-        /* index          */ local_index.dptr(),
+        /* index          */ local_index_ptr,
         /* workspace      */ pooling_workspace.dptr(),
         /* workspace_size */ pooling_workspace_size));
 
-    // cast int32/int16 index to int64 index
-    CnnlTensorDescriptor int32_index_desc;
-    char* int32_index_dptr = reinterpret_cast<char*>(local_index.dptr());
-    if (local_index_dtype == CNNL_DTYPE_INT16) {
-      int32_index_dptr += sizeof(int16_t) * indice->shape_view().elem_cnt();
-      int32_index_desc.set(indice->shape_view().NumAxes(), indice->shape_view().data(),
-                           CNNL_DTYPE_INT32, layout);
-      OF_CNNL_CHECK(cnnlCastDataType(
-          ctx->stream()->As<ep::MluStream>()->cnnl_handle(), local_index_desc.desc(),
-          local_index.dptr(), CNNL_CAST_INT16_TO_INT32, int32_index_desc.desc(), int32_index_dptr));
+    if (convert_format) {
+      ConvertMemoryFormat(ctx->stream(), y_shape, data_type, y_ptr, y->mut_dptr(),
+                          MemoryFormat::kChannelsLast, MemoryFormat::kContiguous);
+      ConvertMemoryFormat(ctx->stream(), y_shape, local_index_data_type, local_index_ptr,
+                          local_index.dptr(), MemoryFormat::kChannelsLast,
+                          MemoryFormat::kContiguous);
     }
-    OF_CNNL_CHECK(cnnlCastDataType(
-        ctx->stream()->As<ep::MluStream>()->cnnl_handle(),
-        (local_index_dtype == CNNL_DTYPE_INT16) ? int32_index_desc.desc() : local_index_desc.desc(),
-        int32_index_dptr, CNNL_CAST_INT32_TO_INT64, indice_desc.desc(), indice->mut_dptr()));
+    mlu::WidenPoolingIndex(ctx->stream(), local_index_data_type, index_elem_cnt,
+                           local_index.dptr(), indice->mut_dptr<int64_t>());
   }
 
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
 
-#define REGISTER_MAX_POOL_MLU_KERNEL(dtype)                           \
-  REGISTER_USER_KERNEL("max_pool_2d")                                 \
-      .SetCreateFn<MluMaxPoolKernel<2, dtype>>()                      \
+#define REGISTER_MAX_POOL_MLU_KERNEL(dim, dtype)                      \
+  REGISTER_USER_KERNEL("max_pool_" #dim "d")                          \
+      .SetCreateFn<MluMaxPoolKernel<dim, dtype>>()                    \
       .SetIsMatchedHob((user_op::HobDeviceType() == DeviceType::kMLU) \
                        && (user_op::HobDataType("x", 0) == GetDataType<dtype>::value));
 
-REGISTER_MAX_POOL_MLU_KERNEL(float)
-REGISTER_MAX_POOL_MLU_KERNEL(float16)
+REGISTER_MAX_POOL_MLU_KERNEL(1, float)
+REGISTER_MAX_POOL_MLU_KERNEL(1, float16)
+REGISTER_MAX_POOL_MLU_KERNEL(2, float)
+REGISTER_MAX_POOL_MLU_KERNEL(2, float16)
+REGISTER_MAX_POOL_MLU_KERNEL(3, float)
+REGISTER_MAX_POOL_MLU_KERNEL(3, float16)
+
+#undef REGISTER_MAX_POOL_MLU_KERNEL
 
 template<int Nd, typename T>
 class MluMaxPoolGradKernel final : public user_op::OpKernel {
@@ -157,117 +171,76 @@ class MluMaxPoolGradKernel final : public user_op::OpKernel {
     const user_op::Tensor* dy = ctx->Tensor4ArgNameAndIndex("dy", 0);
     user_op::Tensor* dx = ctx->Tensor4ArgNameAndIndex("dx", 0);
 
-    const std::vector<int32_t>& padding = ctx->Attr<std::vector<int32_t>>("padding");
-    const std::vector<int32_t>& kernel_size = ctx->Attr<std::vector<int32_t>>("kernel_size");
-    const std::vector<int32_t>& stride = ctx->Attr<std::vector<int32_t>>("stride");
-    const bool ceil_mode = ctx->Attr<bool>("ceil_mode");
     const std::string& data_format = ctx->Attr<std::string>("data_format");
+    const bool channels_last = data_format == "channels_last";
+    const mlu::PoolingWindow3D window = GetMaxPoolingWindow(ctx, Nd);
 
     auto data_type = x->data_type();
     auto cnnl_data_type = ConvertToCnnlDataType(data_type);
-    cnnlTensorLayout_t layout = CNNL_LAYOUT_NHWC;
-    cnnlPoolingMode_t mode = CNNL_POOLING_MAX;
+    cnnlTensorLayout_t layout = mlu::GetCnnlPoolingLayout(window, /*channels_last=*/true);
 
-    CnnlTensorDescriptor x_desc, indice_desc, dy_desc, dx_desc;
-    auto shape = Shape(x->shape_view());
-    auto indice_shape = Shape(indice->shape_view());
-    auto dy_shape = Shape(dy->shape_view());
+    CnnlTensorDescriptor x_desc, local_index_desc, dy_desc, dx_desc;
+    auto shape = mlu::GetCnnlPoolingShape(x->shape_view(), Nd, channels_last);
+    auto indice_shape = mlu::GetCnnlPoolingShape(indice->shape_view(), Nd, channels_last);
+    auto dy_shape = mlu::GetCnnlPoolingShape(dy->shape_view(), Nd, channels_last);
     const void* temp_x = x->dptr();
-    const void* temp_indice = indice->dptr();
     const void* temp_dy = dy->dptr();
     void* temp_dx = dx->mut_dptr();
     CnnlWorkspace temp_x_workspace(ctx->stream()->As<ep::MluStream>());
-    CnnlWorkspace temp_indice_workspace(ctx->stream()->As<ep::MluStream>());
     CnnlWorkspace temp_dy_workspace(ctx->stream()->As<ep::MluStream>());
     CnnlWorkspace temp_dx_workspace(ctx->stream()->As<ep::MluStream>());
 
-    if (data_format != "channels_last") {
+    // cnnlPoolingBackward takes the window local index in its native width, narrow the int64
+    // indice first so that the layout conversion below moves the narrow type
+    const DataType local_index_data_type = mlu::GetPoolingLocalIndexDataType(data_type);
+    const size_t local_index_size =
+        indice_shape.elem_cnt() * GetSizeOfDataType(local_index_data_type);
+    CnnlWorkspace local_index(ctx->stream()->As<ep::MluStream>(), local_index_size);
+    mlu::NarrowPoolingIndex(ctx->stream(), local_index_data_type, indice_shape.elem_cnt(),
+                            indice->dptr<int64_t>(), local_index.dptr());
+    const void* temp_local_index = local_index.dptr();
+    CnnlWorkspace temp_local_index_workspace(ctx->stream()->As<ep::MluStream>());
+
+    if (!channels_last) {
       size_t element_size = GetSizeOfDataType(data_type);
-      shape = ComputeShapeContiguousToChannelsLast(shape);
-      indice_shape = ComputeShapeContiguousToChannelsLast(indice_shape);
-      dy_shape = ComputeShapeContiguousToChannelsLast(dy_shape);
       temp_x_workspace.resize(shape.elem_cnt() * element_size);
-      temp_indice_workspace.resize(indice_shape.elem_cnt()
-                                   * GetSizeOfDataType(indice->data_type()));
+      temp_local_index_workspace.resize(local_index_size);
       temp_dy_workspace.resize(dy_shape.elem_cnt() * element_size);
       temp_dx_workspace.resize(shape.elem_cnt() * element_size);
       // convert x to NHWC
-      ConvertMemoryFormat(ctx->stream(), x->shape_view(), data_type, x->dptr(),
-                          temp_x_workspace.dptr(), MemoryFormat::kContiguous,
-                          MemoryFormat::kChannelsLast);
+      ConvertMemoryFormat(ctx->stream(), shape, data_type, x->dptr(), temp_x_workspace.dptr(),
+                          MemoryFormat::kContiguous, MemoryFormat::kChannelsLast);
       // convert dy to NHWC
-      ConvertMemoryFormat(ctx->stream(), dy->shape_view(), data_type, dy->dptr(),
+      ConvertMemoryFormat(ctx->stream(), dy_shape, data_type, dy->dptr(),
                           temp_dy_workspace.dptr(), MemoryFormat::kContiguous,
                           MemoryFormat::kChannelsLast);
-      // convert indice to NHWC
-      ConvertMemoryFormat(ctx->stream(), indice->shape_view(), indice->data_type(), indice->dptr(),
-                          temp_indice_workspace.dptr(), MemoryFormat::kContiguous,
+      // convert local index to NHWC
+      ConvertMemoryFormat(ctx->stream(), indice_shape, local_index_data_type, local_index.dptr(),
+                          temp_local_index_workspace.dptr(), MemoryFormat::kContiguous,
                           MemoryFormat::kChannelsLast);
+      shape = ComputeShapeContiguousToChannelsLast(shape);
+      indice_shape = ComputeShapeContiguousToChannelsLast(indice_shape);
+      dy_shape = ComputeShapeContiguousToChannelsLast(dy_shape);
       temp_x = temp_x_workspace.dptr();
-      temp_indice = temp_indice_workspace.dptr();
+      temp_local_index = temp_local_index_workspace.dptr();
       temp_dy = temp_dy_workspace.dptr();
       temp_dx = temp_dx_workspace.dptr();
     }
     x_desc.set(shape.size(), shape.data(), cnnl_data_type, layout);
     dy_desc.set(dy_shape.size(), dy_shape.data(), cnnl_data_type, layout);
-    indice_desc.set(indice_shape.size(), indice_shape.data(),
-                    ConvertToCnnlDataType(indice->data_type()), layout);
+    local_index_desc.set(indice_shape.size(), indice_shape.data(),
+                         ConvertToCnnlDataType(local_index_data_type), layout);
     dx_desc.set(shape.size(), shape.data(), cnnl_data_type, layout);
 
-    // cnnlPoolingBackward requires y_desc is int32/int16, which is int64 in oneflow op
-    auto local_index_dtype = CNNL_DTYPE_INVALID;
-    CnnlWorkspace local_index(ctx->stream()->As<ep::MluStream>());
-    if (GetDataType<T>::value == DataType::kFloat) {
-      local_index_dtype = CNNL_DTYPE_INT32;
-      local_index.resize(sizeof(int32_t) * indice_shape.elem_cnt());
-    } else if (GetDataType<T>::value == DataType::kFloat16) {
-      local_index_dtype = CNNL_DTYPE_INT16;
-      local_index.resize(sizeof(int16_t) * indice_shape.elem_cnt() * 3);
-    }
-    CnnlTensorDescriptor local_index_desc;
-    local_index_desc.set(indice_shape.NumAxes(), indice_shape.data(), local_index_dtype, layout);
-
-    if (local_index_dtype == CNNL_DTYPE_INT16) {
-      CnnlTensorDescriptor int32_index_desc;
-      int32_index_desc.set(indice_shape.NumAxes(), indice_shape.data(), CNNL_DTYPE_INT32, layout);
-      char* int32_index_dptr =
-          reinterpret_cast<char*>(local_index.dptr()) + sizeof(int16_t) * indice_shape.elem_cnt();
-      OF_CNNL_CHECK(cnnlCastDataType(
-          /* handle      */ ctx->stream()->As<ep::MluStream>()->cnnl_handle(),
-          /* input_desc  */ indice_desc.desc(),
-          /* input       */ temp_indice,
-          /* cast_type   */ CNNL_CAST_INT64_TO_INT32,
-          /* output_desc */ int32_index_desc.desc(),
-          /* output      */ int32_index_dptr));
-
-      OF_CNNL_CHECK(cnnlCastDataType(
-          /* handle      */ ctx->stream()->As<ep::MluStream>()->cnnl_handle(),
-          /* input_desc  */ int32_index_desc.desc(),
-          /* input       */ int32_index_dptr,
-          /* cast_type   */ CNNL_CAST_INT32_TO_INT16,
-          /* output_desc */ local_index_desc.desc(),
-          /* output      */ local_index.dptr()));
-    } else {
-      OF_CNNL_CHECK(cnnlCastDataType(
-          /* handle      */ ctx->stream()->As<ep::MluStream>()->cnnl_handle(),
-          /* input_desc  */ indice_desc.desc(),
-          /* input       */ temp_indice,
-          /* cast_type   */ CNNL_CAST_INT64_TO_INT32,
-          /* output_desc */ local_index_desc.desc(),
-          /* output      */ local_index.dptr()));
-    }
     CnnlPoolingDescriptor pooling_desc;
-    // calculate paddings
-    int pu = padding[0], pd = padding[0], pl = padding[1], pr = padding[1];
-    pooling_desc.set(mode, kernel_size[0], kernel_size[1], stride[0], stride[1], pu, pd, pl, pr,
-                     ceil_mode);
+    mlu::SetCnnlPoolingDescriptor(&pooling_desc, CNNL_POOLING_MAX, window);
 
     OF_CNNL_CHECK(cnnlPoolingBackward(
         /* handle       */ ctx->stream()->As<ep::MluStream>()->cnnl_handle(),
         /* pooling_desc */ pooling_desc.desc(),
         /* alpha        */ nullptr,
         /* y_desc       */ local_index_desc.desc(),
-        /* y            */ local_index.dptr(),
+        /* y            */ temp_local_index,
         /* diff_y_desc  */ dy_desc.desc(),
         /* diff_y       */ temp_dy,
         /* x_desc       */ x_desc.desc(),
@@ -276,7 +249,7 @@ class MluMaxPoolGradKernel final : public user_op::OpKernel {
         /* diff_x_desc  */ dx_desc.desc(),
         /* diff_x       */ temp_dx));
 
-    if (data_format != "channels_last") {
+    if (!channels_last) {
       // convert dx to NCHW
       ConvertMemoryFormat(ctx->stream(), shape, data_type, temp_dx, dx->mut_dptr(),
                           MemoryFormat::kChannelsLast, MemoryFormat::kContiguous);
@@ -286,14 +259,20 @@ class MluMaxPoolGradKernel final : public user_op::OpKernel {
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
 
-#define REGISTER_MAX_POOL_GRAD_MLU_KERNEL(x_dtype, indice_dtype)                        \
-  REGISTER_USER_KERNEL("max_pool_2d_grad")                                              \
-      .SetCreateFn<MluMaxPoolGradKernel<2, x_dtype>>()                                  \
+#define REGISTER_MAX_POOL_GRAD_MLU_KERNEL(dim, x_dtype, indice_dtype)                   \
+  REGISTER_USER_KERNEL("max_pool_" #dim "d_grad")                                       \
+      .SetCreateFn<MluMaxPoolGradKernel<dim, x_dtype>>()                                \
       .SetIsMatchedHob((user_op::HobDeviceType() == DeviceType::kMLU)                   \
                        && (user_op::HobDataType("x", 0) == GetDataType<x_dtype>::value) \
                        && user_op::HobDataType("indice", 0) == GetDataType<indice_dtype>::value);
 
-REGISTER_MAX_POOL_GRAD_MLU_KERNEL(float, int64_t)
-REGISTER_MAX_POOL_GRAD_MLU_KERNEL(float16, int64_t)
+REGISTER_MAX_POOL_GRAD_MLU_KERNEL(1, float, int64_t)
+REGISTER_MAX_POOL_GRAD_MLU_KERNEL(1, float16, int64_t)
+REGISTER_MAX_POOL_GRAD_MLU_KERNEL(2, float, int64_t)
+REGISTER_MAX_POOL_GRAD_MLU_KERNEL(2, float16, int64_t)
+REGISTER_MAX_POOL_GRAD_MLU_KERNEL(3, float, int64_t)
+REGISTER_MAX_POOL_GRAD_MLU_KERNEL(3, float16, int64_t)
+
+#undef REGISTER_MAX_POOL_GRAD_MLU_KERNEL
 
 }  // namespace oneflow
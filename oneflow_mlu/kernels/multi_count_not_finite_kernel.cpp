@@ -43,18 +43,19 @@ class MluMultiCountNotFiniteKernel final : public user_op::OpKernel {
     auto* stream = ctx->stream()->As<ep::MluStream>();
     BangHandle handle(stream->mlu_stream(), stream->device()->nclusters(),
                       stream->device()->ncores_per_cluster());
-    size_t workspace_size =
-        stream->device()->nclusters() * stream->device()->ncores_per_cluster() * sizeof(int64_t);
-    CnnlWorkspace workspace(stream, workspace_size);
+    CnnlWorkspace workspace(stream, bang_multi_tensor_norm_workspace_size(handle));
 
+    // without norm output the norm is not accumulated, only the not finite elements are counted
     if constexpr (std::is_same<T, float16>::value) {
-      bang_multi_count_not_finite_half_kernel(
-          handle, input_num, reinterpret_cast<const void**>(inputs.data()), sizes.data(),
-          y->mut_dptr<int64_t>(), workspace.dptr(), workspace_size);
+      bang_multi_tensor_norm_half_kernel(
+          handle, input_num, reinterpret_cast<const void**>(inputs.data()), sizes.data(), 0.f,
+          /*take_root=*/false, /*norm=*/nullptr, y->mut_dptr<int64_t>(), /*clip=*/false, 0.f,
+          workspace.dptr());
     } else {
-      bang_multi_count_not_finite_kernel<T>(handle, input_num, inputs.data(), sizes.data(),
-                                            y->mut_dptr<int64_t>(), workspace.dptr(),
-                                            workspace_size);
+      bang_multi_tensor_norm_kernel<T>(handle, input_num, inputs.data(), sizes.data(), 0.f,
+                                       /*take_root=*/false, /*norm=*/nullptr,
+                                       y->mut_dptr<int64_t>(), /*clip=*/false, 0.f,
+                                       workspace.dptr());
     }
   }
 
@@ -42,13 +42,22 @@ class MluMultiReduceSumPowAbsKernel final : public user_op::OpKernel {
     }
     float p = ctx->Attr<float>("p");
     auto* stream = ctx->stream()->As<ep::MluStream>();
-    size_t workspace_size = input_num * sizeof(T);
-    CnnlWorkspace workspace(stream, workspace_size);
-
     BangHandle handle(stream->mlu_stream(), stream->device()->nclusters(),
                       stream->device()->ncores_per_cluster());
-    bang_multi_reduce_sum_pow_abs_kernel<T>(handle, input_num, inputs.data(), sizes.data(),
-                                            y->mut_dptr<T>(), p, workspace.dptr(), workspace_size);
+    CnnlWorkspace workspace(stream, bang_multi_tensor_norm_workspace_size(handle));
+
+    if constexpr (std::is_same<T, float16>::value) {
+      bang_multi_tensor_norm_half_kernel(handle, input_num,
+                                         reinterpret_cast<const void**>(inputs.data()),
+                                         sizes.data(), p, /*take_root=*/false, y->mut_dptr(),
+                                         /*not_finite=*/nullptr, /*clip=*/false, 0.f,
+                                         workspace.dptr());
+    } else {
+      bang_multi_tensor_norm_kernel<T>(handle, input_num, inputs.data(), sizes.data(), p,
+                                       /*take_root=*/false, y->mut_dptr<T>(),
+                                       /*not_finite=*/nullptr, /*clip=*/false, 0.f,
+                                       workspace.dptr());
+    }
   }
 
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
@@ -61,6 +70,7 @@ class MluMultiReduceSumPowAbsKernel final : public user_op::OpKernel {
                        && (user_op::HobDataType("y", 0) == GetDataType<dtype>::value));
 
 REGISTER_MLU_MULTI_REDUCE_SUM_POW_ABS_KERNEL(float)
+REGISTER_MLU_MULTI_REDUCE_SUM_POW_ABS_KERNEL(float16)
 
 #undef REGISTER_MLU_MULTI_REDUCE_SUM_POW_ABS_KERNEL
 
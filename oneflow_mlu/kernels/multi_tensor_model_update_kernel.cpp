@@ -0,0 +1,274 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow_mlu/bang/bang_kernels.h"
+#include "oneflow_mlu/common/mlu_util.h"
+#include "oneflow_mlu/ep/mlu_stream.h"
+#include "oneflow/core/framework/framework.h"
+
+namespace oneflow {
+
+namespace {
+
+template<typename T>
+struct MultiTensorUpdateScalars {
+  const float* learning_rate_ptr = nullptr;
+  const T* scale_by_ptr = nullptr;
+  const int64_t* skip_if_ptr = nullptr;
+};
+
+template<typename T>
+MultiTensorUpdateScalars<T> GetMultiTensorUpdateScalars(user_op::KernelComputeContext* ctx) {
+  MultiTensorUpdateScalars<T> scalars;
+  if (ctx->has_input("learning_rate", 0)) {
+    const user_op::Tensor* learning_rate = ctx->Tensor4ArgNameAndIndex("learning_rate", 0);
+    scalars.learning_rate_ptr = learning_rate->dptr<float>();
+  }
+  if (ctx->has_input("scale_by_tensor", 0)) {
+    const user_op::Tensor* scale_by_tensor = ctx->Tensor4ArgNameAndIndex("scale_by_tensor", 0);
+    CHECK_EQ(scale_by_tensor->data_type(), ctx->Tensor4ArgNameAndIndex("model", 0)->data_type());
+    CHECK_EQ(scale_by_tensor->shape_view().elem_cnt(), 1);
+    scalars.scale_by_ptr = scale_by_tensor->dptr<T>();
+  }
+  if (ctx->has_input("skip_if", 0)) {
+    const user_op::Tensor* skip_if = ctx->Tensor4ArgNameAndIndex("skip_if", 0);
+    CHECK_EQ(skip_if->shape_view().elem_cnt(), 1);
+    scalars.skip_if_ptr = skip_if->dptr<int64_t>();
+  }
+  return scalars;
+}
+
+// Device pointers of the variadic inputs, one entry per parameter.
+template<typename T, typename G>
+struct MultiTensorUpdateArgs {
+  std::vector<int64_t> sizes;
+  std::vector<T*> model;
+  std::vector<const G*> model_diff;
+  std::vector<void*> model_copy;
+  std::vector<T*> state0;
+  std::vector<T*> state1;
+
+  void** model_copy_ptr() { return model_copy.empty() ? nullptr : model_copy.data(); }
+};
+
+template<typename T, typename G>
+MultiTensorUpdateArgs<T, G> GetMultiTensorUpdateArgs(user_op::KernelComputeContext* ctx,
+                                                     const std::string& state0_name,
+                                                     const std::string& state1_name) {
+  const int64_t n = ctx->input_size("model");
+  const bool has_model_copy = ctx->has_input("model_copy", 0);
+  MultiTensorUpdateArgs<T, G> args;
+  for (int64_t i = 0; i < n; ++i) {
+    user_op::Tensor* model = ctx->Tensor4ArgNameAndIndex("model", i);
+    const int64_t elem_cnt = model->shape_view().elem_cnt();
+    if (elem_cnt == 0) { continue; }
+    args.sizes.push_back(elem_cnt);
+    args.model.push_back(model->mut_dptr<T>());
+    args.model_diff.push_back(ctx->Tensor4ArgNameAndIndex("model_diff", i)->dptr<G>());
+    if (has_model_copy) {
+      args.model_copy.push_back(ctx->Tensor4ArgNameAndIndex("model_copy", i)->mut_dptr());
+    }
+    if (!state0_name.empty()) {
+      args.state0.push_back(ctx->Tensor4ArgNameAndIndex(state0_name, i)->mut_dptr<T>());
+    }
+    if (!state1_name.empty()) {
+      args.state1.push_back(ctx->Tensor4ArgNameAndIndex(state1_name, i)->mut_dptr<T>());
+    }
+  }
+  return args;
+}
+
+template<typename T, typename G>
+class MluMultiTensorSGDUpdateKernel final : public user_op::OpKernel {
+ public:
+  MluMultiTensorSGDUpdateKernel() = default;
+  ~MluMultiTensorSGDUpdateKernel() override = default;
+
+ private:
+  using user_op::OpKernel::Compute;
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const double scale = ctx->Attr<double>("scale");
+    const float l1 = ctx->Attr<float>("l1");
+    const float l2 = ctx->Attr<float>("l2");
+    const float weight_decay = ctx->Attr<float>("weight_decay");
+    const float learning_rate_val = ctx->Attr<float>("learning_rate_val");
+    const auto scalars = GetMultiTensorUpdateScalars<T>(ctx);
+    auto args = GetMultiTensorUpdateArgs<T, G>(ctx, "", "");
+    if (args.sizes.empty()) { return; }
+
+    auto* stream = ctx->stream()->As<ep::MluStream>();
+    BangHandle handle(stream->mlu_stream(), stream->device()->nclusters(),
+                      stream->device()->ncores_per_cluster());
+    if constexpr (std::is_same<G, float16>::value) {
+      bang_multi_tensor_sgd_update_half_kernel<T>(
+          handle, args.sizes.size(), args.sizes.data(), static_cast<T>(scale), l1, l2,
+          weight_decay, learning_rate_val, scalars.learning_rate_ptr, scalars.scale_by_ptr,
+          scalars.skip_if_ptr, reinterpret_cast<const void**>(args.model_diff.data()),
+          args.model.data(), args.model_copy_ptr());
+    } else {
+      bang_multi_tensor_sgd_update_kernel<T>(
+          handle, args.sizes.size(), args.sizes.data(), static_cast<T>(scale), l1, l2,
+          weight_decay, learning_rate_val, scalars.learning_rate_ptr, scalars.scale_by_ptr,
+          scalars.skip_if_ptr, args.model_diff.data(), args.model.data(), args.model_copy_ptr());
+    }
+  }
+
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return true; }
+};
+
+template<typename T, typename G>
+class MluMultiTensorMomentumUpdateKernel final : public user_op::OpKernel {
+ public:
+  MluMultiTensorMomentumUpdateKernel() = default;
+  ~MluMultiTensorMomentumUpdateKernel() override = default;
+
+ private:
+  using user_op::OpKernel::Compute;
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const double scale = ctx->Attr<double>("scale");
+    const float l1 = ctx->Attr<float>("l1");
+    const float l2 = ctx->Attr<float>("l2");
+    const float weight_decay = ctx->Attr<float>("weight_decay");
+    const float learning_rate_val = ctx->Attr<float>("learning_rate_val");
+    const float beta = ctx->Attr<float>("momentum");
+    const float dampening = ctx->Attr<float>("dampening");
+    const bool nesterov = ctx->Attr<bool>("nesterov");
+    const bool maximize = ctx->Attr<bool>("maximize");
+    const auto scalars = GetMultiTensorUpdateScalars<T>(ctx);
+    auto args = GetMultiTensorUpdateArgs<T, G>(ctx, "momentum_buf", "");
+    if (args.sizes.empty()) { return; }
+
+    auto* stream = ctx->stream()->As<ep::MluStream>();
+    BangHandle handle(stream->mlu_stream(), stream->device()->nclusters(),
+                      stream->device()->ncores_per_cluster());
+    if constexpr (std::is_same<G, float16>::value) {
+      bang_multi_tensor_momentum_update_half_kernel<T>(
+          handle, args.sizes.size(), args.sizes.data(), static_cast<T>(scale), l1, l2, beta,
+          dampening, nesterov, maximize, weight_decay, learning_rate_val,
+          scalars.learning_rate_ptr, scalars.scale_by_ptr, scalars.skip_if_ptr,
+          reinterpret_cast<const void**>(args.model_diff.data()), args.model.data(),
+          args.state0.data(), args.model_copy_ptr());
+    } else {
+      bang_multi_tensor_momentum_update_kernel<T>(
+          handle, args.sizes.size(), args.sizes.data(), static_cast<T>(scale), l1, l2, beta,
+          dampening, nesterov, maximize, weight_decay, learning_rate_val,
+          scalars.learning_rate_ptr, scalars.scale_by_ptr, scalars.skip_if_ptr,
+          args.model_diff.data(), args.model.data(), args.state0.data(), args.model_copy_ptr());
+    }
+  }
+
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return true; }
+};
+
+template<typename T, typename G>
+class MluMultiTensorAdamUpdateKernel final : public user_op::OpKernel {
+ public:
+  MluMultiTensorAdamUpdateKernel() = default;
+  ~MluMultiTensorAdamUpdateKernel() override = default;
+
+ private:
+  using user_op::OpKernel::Compute;
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const double scale = ctx->Attr<double>("scale");
+    const float l1 = ctx->Attr<float>("l1");
+    const float l2 = ctx->Attr<float>("l2");
+    const float beta1 = ctx->Attr<float>("beta1");
+    const float beta2 = ctx->Attr<float>("beta2");
+    const float epsilon = ctx->Attr<float>("epsilon");
+    const float weight_decay = ctx->Attr<float>("weight_decay");
+    const bool amsgrad = ctx->Attr<bool>("amsgrad");
+    const bool do_bias_correction = ctx->Attr<bool>("do_bias_correction");
+    CHECK(!amsgrad) << "multi tensor adam update does not support amsgrad = True";
+    const float learning_rate_val = ctx->Attr<float>("learning_rate_val");
+    const float bias_correction1_val = ctx->Attr<float>("bias_correction1_val");
+    const float bias_correction2_val = ctx->Attr<float>("bias_correction2_val");
+
+    const float* bias_correction1_ptr = nullptr;
+    if (ctx->has_input("bias_correction1", 0)) {
+      const user_op::Tensor* bias_correction1 = ctx->Tensor4ArgNameAndIndex("bias_correction1", 0);
+      CHECK_EQ(bias_correction1->shape_view().elem_cnt(), 1);
+      bias_correction1_ptr = bias_correction1->dptr<float>();
+    }
+    const float* bias_correction2_ptr = nullptr;
+    if (ctx->has_input("bias_correction2", 0)) {
+      const user_op::Tensor* bias_correction2 = ctx->Tensor4ArgNameAndIndex("bias_correction2", 0);
+      CHECK_EQ(bias_correction2->shape_view().elem_cnt(), 1);
+      bias_correction2_ptr = bias_correction2->dptr<float>();
+    }
+    const auto scalars = GetMultiTensorUpdateScalars<T>(ctx);
+    auto args = GetMultiTensorUpdateArgs<T, G>(ctx, "m", "v");
+    if (args.sizes.empty()) { return; }
+
+    auto* stream = ctx->stream()->As<ep::MluStream>();
+    BangHandle handle(stream->mlu_stream(), stream->device()->nclusters(),
+                      stream->device()->ncores_per_cluster());
+    if constexpr (std::is_same<G, float16>::value) {
+      bang_multi_tensor_adam_update_half_kernel<T>(
+          handle, args.sizes.size(), args.sizes.data(), static_cast<T>(scale), l1, l2, beta1,
+          beta2, epsilon, weight_decay, do_bias_correction, learning_rate_val,
+          bias_correction1_val, bias_correction2_val, scalars.learning_rate_ptr,
+          scalars.scale_by_ptr, scalars.skip_if_ptr, bias_correction1_ptr, bias_correction2_ptr,
+          reinterpret_cast<const void**>(args.model_diff.data()), args.model.data(),
+          args.state0.data(), args.state1.data(), args.model_copy_ptr());
+    } else {
+      bang_multi_tensor_adam_update_kernel<T>(
+          handle, args.sizes.size(), args.sizes.data(), static_cast<T>(scale), l1, l2, beta1,
+          beta2, epsilon, weight_decay, do_bias_correction, learning_rate_val,
+          bias_correction1_val, bias_correction2_val, scalars.learning_rate_ptr,
+          scalars.scale_by_ptr, scalars.skip_if_ptr, bias_correction1_ptr, bias_correction2_ptr,
+          args.model_diff.data(), args.model.data(), args.state0.data(), args.state1.data(),
+          args.model_copy_ptr());
+    }
+  }
+
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return true; }
+};
+
+#define REGISTER_MLU_MULTI_TENSOR_UPDATE_KERNEL(op_type_name, kernel, dtype, gtype)       \
+  REGISTER_USER_KERNEL(op_type_name)                                                      \
+      .SetCreateFn<kernel<dtype, gtype>>()                                                \
+      .SetIsMatchedHob((user_op::HobDeviceType() == DeviceType::kMLU)                     \
+                       && (user_op::HobDataType("model", 0) == GetDataType<dtype>::value) \
+                       && (user_op::HobDataType("model_diff", 0) == GetDataType<gtype>::value));
+
+#define REGISTER_MLU_MULTI_TENSOR_UPDATE_WITH_CAST_KERNEL(op_type_name, kernel, dtype, gtype)  \
+  REGISTER_USER_KERNEL(op_type_name)                                                           \
+      .SetCreateFn<kernel<dtype, gtype>>()                                                     \
+      .SetIsMatchedHob((user_op::HobDeviceType() == DeviceType::kMLU)                          \
+                       && (user_op::HobDataType("model", 0) == GetDataType<dtype>::value)      \
+                       && (user_op::HobDataType("model_diff", 0) == GetDataType<gtype>::value) \
+                       && (user_op::HobDataType("model_copy", 0) == DataType::kFloat16));
+
+#define REGISTER_MLU_MULTI_TENSOR_OPTIMIZER_KERNELS(op_type_name, kernel)                     \
+  REGISTER_MLU_MULTI_TENSOR_UPDATE_KERNEL(op_type_name, kernel, float, float)                 \
+  REGISTER_MLU_MULTI_TENSOR_UPDATE_KERNEL(op_type_name, kernel, float, float16)               \
+  REGISTER_MLU_MULTI_TENSOR_UPDATE_WITH_CAST_KERNEL(op_type_name "_with_cast", kernel, float, \
+                                                    float)                                    \
+  REGISTER_MLU_MULTI_TENSOR_UPDATE_WITH_CAST_KERNEL(op_type_name "_with_cast", kernel, float, \
+                                                    float16)
+
+REGISTER_MLU_MULTI_TENSOR_OPTIMIZER_KERNELS("multi_tensor_sgd_update",
+                                            MluMultiTensorSGDUpdateKernel)
+REGISTER_MLU_MULTI_TENSOR_OPTIMIZER_KERNELS("multi_tensor_momentum_update",
+                                            MluMultiTensorMomentumUpdateKernel)
+REGISTER_MLU_MULTI_TENSOR_OPTIMIZER_KERNELS("multi_tensor_adam_update",
+                                            MluMultiTensorAdamUpdateKernel)
+
+#undef REGISTER_MLU_MULTI_TENSOR_OPTIMIZER_KERNELS
+#undef REGISTER_MLU_MULTI_TENSOR_UPDATE_WITH_CAST_KERNEL
+#undef REGISTER_MLU_MULTI_TENSOR_UPDATE_KERNEL
+
+}  // namespace
+}  // namespace oneflow
@@ -0,0 +1,238 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CAMBRICON_KERNELS_POOLING_UTIL_H_
+#define ONEFLOW_CAMBRICON_KERNELS_POOLING_UTIL_H_
+
+#include "oneflow_mlu/bang/bang_kernels.h"
+#include "oneflow_mlu/cnnl/cnnl_op_descriptor.h"
+#include "oneflow_mlu/cnnl/cnnl_tensor_descriptor.h"
+#include "oneflow_mlu/cnnl/cnnl_workspace.h"
+#include "oneflow_mlu/ep/mlu_stream.h"
+#include "oneflow/core/common/data_type.h"
+#include "oneflow/core/common/shape.h"
+
+namespace oneflow {
+namespace mlu {
+
+// cnnl max pooling functions produce and consume window local indices of int32 for float inputs
+// and int16 for half inputs, while the pooling ops hold them as int64.
+inline DataType GetPoolingLocalIndexDataType(DataType data_type) {
+  return data_type == DataType::kFloat16 ? DataType::kInt16 : DataType::kInt32;
+}
+
+inline void WidenPoolingIndex(ep::Stream* stream, DataType local_index_data_type,
+                              int64_t elem_cnt, const void* local_index, int64_t* index) {
+  if (elem_cnt == 0) { return; }
+  auto* mlu_stream = stream->As<ep::MluStream>();
+  BangHandle handle(mlu_stream->mlu_stream(), mlu_stream->device()->nclusters(),
+                    mlu_stream->device()->ncores_per_cluster());
+  if (local_index_data_type == DataType::kInt16) {
+    bang_widen_index_kernel(handle, elem_cnt, static_cast<const int16_t*>(local_index), index);
+  } else {
+    CHECK_EQ(local_index_data_type, DataType::kInt32);
+    bang_widen_index_kernel(handle, elem_cnt, static_cast<const int32_t*>(local_index), index);
+  }
+}
+
+inline void NarrowPoolingIndex(ep::Stream* stream, DataType local_index_data_type,
+                               int64_t elem_cnt, const int64_t* index, void* local_index) {
+  if (elem_cnt == 0) { return; }
+  auto* mlu_stream = stream->As<ep::MluStream>();
+  BangHandle handle(mlu_stream->mlu_stream(), mlu_stream->device()->nclusters(),
+                    mlu_stream->device()->ncores_per_cluster());
+  if (local_index_data_type == DataType::kInt16) {
+    bang_narrow_index_kernel(handle, elem_cnt, index, static_cast<int16_t*>(local_index));
+  } else {
+    CHECK_EQ(local_index_data_type, DataType::kInt32);
+    bang_narrow_index_kernel(handle, elem_cnt, index, static_cast<int32_t*>(local_index));
+  }
+}
+
+// Window of a 1d, 2d or 3d pooling in depth, height, width order. 1d pooling runs as 2d pooling
+// with a unit height, which only reinterprets the tensors instead of copying them.
+struct PoolingWindow3D {
+  int32_t num_dims = 0;
+  int32_t kernel_size[3] = {1, 1, 1};
+  int32_t stride[3] = {1, 1, 1};
+  int32_t padding[3] = {0, 0, 0};
+  int32_t dilation[3] = {1, 1, 1};
+  bool ceil_mode = false;
+
+  // spatial dims of the cnnl pooling
+  int32_t cnnl_num_dims() const { return num_dims == 3 ? 3 : 2; }
+  int64_t kernel_volume() const {
+    return static_cast<int64_t>(kernel_size[0]) * kernel_size[1] * kernel_size[2];
+  }
+};
+
+// Attrs hold either num_dims values or already 3d values, the trailing num_dims are taken. An
+// empty dilation means no dilation.
+inline PoolingWindow3D MakePoolingWindow3D(int32_t num_dims,
+                                           const std::vector<int32_t>& kernel_size,
+                                           const std::vector<int32_t>& stride,
+                                           const std::vector<int32_t>& padding,
+                                           const std::vector<int32_t>& dilation, bool ceil_mode) {
+  CHECK_OR_THROW(num_dims >= 1 && num_dims <= 3) << "invalid pooling dims " << num_dims;
+  PoolingWindow3D window;
+  window.num_dims = num_dims;
+  window.ceil_mode = ceil_mode;
+  auto fill = [&](const std::vector<int32_t>& attr, int32_t* dst) {
+    if (attr.empty()) { return; }
+    CHECK_OR_THROW(attr.size() >= static_cast<size_t>(num_dims))
+        << "pooling attr size should be " << num_dims;
+    for (int32_t i = 0; i < num_dims; ++i) {
+      dst[3 - num_dims + i] = attr[attr.size() - num_dims + i];
+    }
+  };
+  fill(kernel_size, window.kernel_size);
+  fill(stride, window.stride);
+  fill(padding, window.padding);
+  fill(dilation, window.dilation);
+  return window;
+}
+
+// Shape handed to cnnl: 1d tensors get a unit height, (N, C, L) -> (N, C, 1, L) and
+// (N, L, C) -> (N, 1, L, C).
+inline Shape GetCnnlPoolingShape(const ShapeView& shape, int32_t num_dims, bool channels_last) {
+  const int64_t unit_axis = num_dims == 1 ? (channels_last ? 1 : 2) : -1;
+  DimVector dim_vec;
+  for (int64_t i = 0; i < shape.NumAxes(); ++i) {
+    if (i == unit_axis) { dim_vec.push_back(1); }
+    dim_vec.push_back(shape.At(i));
+  }
+  return Shape(dim_vec);
+}
+
+inline cnnlTensorLayout_t GetCnnlPoolingLayout(const PoolingWindow3D& window,
+                                               bool channels_last) {
+  if (window.cnnl_num_dims() == 3) { return channels_last ? CNNL_LAYOUT_NDHWC : CNNL_LAYOUT_NCDHW; }
+  return channels_last ? CNNL_LAYOUT_NHWC : CNNL_LAYOUT_NCHW;
+}
+
+inline void SetCnnlPoolingDescriptor(CnnlPoolingDescriptor* pooling_desc, cnnlPoolingMode_t mode,
+                                     const PoolingWindow3D& window) {
+  if (window.cnnl_num_dims() == 3) {
+    const int padding[6] = {window.padding[0], window.padding[0], window.padding[1],
+                            window.padding[1], window.padding[2], window.padding[2]};
+    pooling_desc->set(mode, 3, window.kernel_size, window.stride, padding, window.dilation,
+                      window.ceil_mode);
+  } else {
+    CHECK_OR_THROW(window.dilation[1] == 1 && window.dilation[2] == 1)
+        << "cambricon cnnl 2d pooling only supports dilation 1.";
+    pooling_desc->set(mode, window.kernel_size[1], window.kernel_size[2], window.stride[1],
+                      window.stride[2], window.padding[1], window.padding[1], window.padding[2],
+                      window.padding[2], window.ceil_mode);
+  }
+}
+
+// Adaptive pooling whose output size divides the input size pools non-overlapping windows of
+// (H / OH, W / OW), so it is a reduce over the window axes of a view of x without any layout
+// change, e.g. (N * C, OH, H / OH, OW, W / OW) for channels_first. Unit axes are dropped and
+// neighbouring axes of the same kind merged, a 1x1 output reduces the trailing H * W of
+// (N * C, H * W).
+struct AdaptivePoolingReduceView {
+  DimVector in_dims;
+  DimVector out_dims;
+  std::vector<int32_t> axes;
+  int64_t window_size = 1;
+};
+
+inline bool GetAdaptivePoolingReduceView(const ShapeView& in_shape, const ShapeView& out_shape,
+                                         bool channels_last, AdaptivePoolingReduceView* view) {
+  CHECK_EQ(in_shape.NumAxes(), 4);
+  const int64_t h_axis = channels_last ? 1 : 2;
+  const int64_t h = in_shape.At(h_axis);
+  const int64_t w = in_shape.At(h_axis + 1);
+  const int64_t oh = out_shape.At(h_axis);
+  const int64_t ow = out_shape.At(h_axis + 1);
+  if (oh <= 0 || ow <= 0 || h % oh != 0 || w % ow != 0) { return false; }
+  // (size, is window axis) in memory order
+  std::vector<std::pair<int64_t, bool>> dims;
+  if (channels_last) {
+    dims = {{in_shape.At(0), false}, {oh, false},    {h / oh, true},
+            {ow, false},             {w / ow, true}, {in_shape.At(3), false}};
+  } else {
+    dims = {{in_shape.At(0) * in_shape.At(1), false},
+            {oh, false},
+            {h / oh, true},
+            {ow, false},
+            {w / ow, true}};
+  }
+  view->in_dims.clear();
+  view->out_dims.clear();
+  view->axes.clear();
+  view->window_size = (h / oh) * (w / ow);
+  bool last_is_window = false;
+  for (const auto& dim : dims) {
+    if (dim.first == 1) { continue; }
+    if (!view->in_dims.empty() && last_is_window == dim.second) {
+      view->in_dims.back() *= dim.first;
+      if (!dim.second) { view->out_dims.back() *= dim.first; }
+      continue;
+    }
+    view->in_dims.push_back(dim.first);
+    view->out_dims.push_back(dim.second ? 1 : dim.first);
+    if (dim.second) { view->axes.push_back(view->in_dims.size() - 1); }
+    last_is_window = dim.second;
+  }
+  // a unit window still needs an axis to reduce over
+  if (view->axes.empty()) {
+    view->in_dims.push_back(1);
+    view->out_dims.push_back(1);
+    view->axes.push_back(view->in_dims.size() - 1);
+  }
+  return true;
+}
+
+// Reduces x into y over the window axes of the view. With a single window axis, indices may
+// receive the int32 position of the max inside each window.
+inline void LaunchAdaptivePoolingReduce(ep::Stream* stream, DataType data_type,
+                                        const AdaptivePoolingReduceView& view,
+                                        cnnlReduceOp_t mode, const void* x, void* y,
+                                        int32_t* indices) {
+  auto* mlu_stream = stream->As<ep::MluStream>();
+  const cnnlDataType_t dtype = ConvertToCnnlDataType(data_type);
+  // accumulate half averages in float, a global pooling easily sums thousands of elements
+  const cnnlDataType_t compute_dtype =
+      (mode == CNNL_REDUCE_AVG && data_type == DataType::kFloat16) ? CNNL_DTYPE_FLOAT : dtype;
+  CnnlTensorDescriptor in_desc, out_desc;
+  in_desc.set(view.in_dims.size(), view.in_dims.data(), dtype);
+  out_desc.set(view.out_dims.size(), view.out_dims.data(), dtype);
+  size_t indices_size = 0;
+  if (indices != nullptr) {
+    CHECK_EQ(view.axes.size(), 1);
+    int64_t out_elem_cnt = 1;
+    for (int64_t dim : view.out_dims) { out_elem_cnt *= dim; }
+    indices_size = out_elem_cnt * sizeof(int32_t);
+  }
+  CnnlReduceDescriptor reduce_desc;
+  reduce_desc.set(compute_dtype, view.axes, mode,
+                  indices != nullptr ? CNNL_REDUCE_FLATTENED_INDICES : CNNL_REDUCE_NO_INDICES,
+                  CNNL_32BIT_INDICES);
+  size_t workspace_size = 0;
+  OF_CNNL_CHECK(cnnlGetReduceOpWorkspaceSize(mlu_stream->cnnl_handle(), in_desc.desc(),
+                                             out_desc.desc(), reduce_desc.mut_desc(),
+                                             &workspace_size));
+  CnnlWorkspace workspace(mlu_stream, workspace_size);
+  OF_CNNL_CHECK(cnnlReduce(mlu_stream->cnnl_handle(), reduce_desc.desc(), workspace.dptr(),
+                           workspace_size, nullptr, in_desc.desc(), x, indices_size, indices,
+                           nullptr, out_desc.desc(), y));
+}
+
+}  // namespace mlu
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CAMBRICON_KERNELS_POOLING_UTIL_H_
@@ -13,11 +13,10 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 */
-#include "oneflow_mlu/cnnl/cnnl_workspace.h"
+#include "oneflow_mlu/bang/bang_kernels.h"
 #include "oneflow_mlu/ep/mlu_random_generator.h"
 #include "oneflow_mlu/ep/mlu_stream.h"
 #include "oneflow/core/ep/include/device.h"
-#include "oneflow/core/ep/include/primitive/broadcast_elementwise_binary.h"
 #include "oneflow/core/framework/framework.h"
 #include "oneflow/user/kernels/random_mask_like_kernel.h"
 #include "oneflow/user/kernels/random_seed_util.h"
@@ -50,22 +49,11 @@ class MluRandomMaskLikeKernel final : public user_op::OpKernel {
         CHECK_JUST(random_mask_like_state->generator()->Get<ep::MLUGenerator>());
     CHECK_NOTNULL(generator);
 
-    auto cnnl_handle = ctx->stream()->As<ep::MluStream>()->cnnl_handle();
-    // update generator state
-    if (generator->need_update_state()) { generator->update_state(cnnl_handle); }
-
-    int64_t count = out->shape_view().elem_cnt();
-    CnnlWorkspace workspace(ctx->stream()->As<ep::MluStream>(), count * sizeof(float));
-
-    OF_CNNL_CHECK(cnnlRandGenerateUniform(cnnl_handle, generator->cnnl_rng(), CNNL_DTYPE_FLOAT,
-                                          generator->state(), out->shape_view().elem_cnt(), 0.f,
-                                          1.f, workspace.dptr()));
-
-    auto primitive = ep::primitive::NewPrimitive<ep::primitive::BroadcastElementwiseBinaryFactory>(
-        DeviceType::kMLU, ep::primitive::BinaryOp::kGreaterThan, DataType::kFloat, DataType::kBool,
-        1);
-    int64_t dims[1] = {count};
-    primitive->Launch(ctx->stream(), 1, dims, workspace.dptr(), Scalar(rate), out->mut_dptr());
+    auto* stream = ctx->stream()->As<ep::MluStream>();
+    BangHandle handle(stream->mlu_stream(), stream->device()->nclusters(),
+                      stream->device()->ncores_per_cluster());
+    bang_philox_random_mask_kernel(handle, out->shape_view().elem_cnt(), generator->current_seed(),
+                                   generator->get_philox_offset(1), rate, out->mut_dptr<bool>());
   }
 
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
@@ -15,8 +15,11 @@ limitations under the License.
 */
 #include "oneflow_mlu/kernels/slice_util.h"
 
+#include <limits>
+
+#include "oneflow_mlu/bang/bang_kernels.h"
+#include "oneflow_mlu/cnnl/cnnl_copy.h"
 #include "oneflow_mlu/cnnl/cnnl_tensor_descriptor.h"
-#include "oneflow_mlu/cnnl/cnnl_workspace.h"
 #include "oneflow_mlu/common/mlu_util.h"
 #include "oneflow_mlu/ep/mlu_stream.h"
 
@@ -33,8 +36,44 @@ bool IsContiguous(size_t num_dims, const int64_t* dims, const int64_t* strides)
   return true;
 }
 
-void SliceKernelUtil::Forward(ep::Stream* stream, const SliceParams& params, DataType data_type,
-                              const void* entire, void* sliced) {
+namespace {
+
+// cnnlStridedSlice takes int begin/end/stride and a contiguous input, other slices are done as a
+// strided copy instead.
+bool CanUseCnnlStridedSlice(const SliceParams& params) {
+  for (int i = 0; i < params.ndim; ++i) {
+    if (params.dims[i] > std::numeric_limits<int>::max()) { return false; }
+  }
+  return IsContiguous(params.ndim, params.dims, params.stride)
+         && IsCnnlDescribable(params.ndim, params.dims, params.stride);
+}
+
+// Gathers the slice of entire described by params into sliced laid out by sliced_stride in one
+// pass, both sides may be strided.
+void SliceByStridedCopy(ep::Stream* stream, const SliceParams& params, DataType data_type,
+                        const void* entire, void* sliced, const int64_t* sliced_stride) {
+  const int64_t elem_size = GetSizeOfDataType(data_type);
+  int64_t entire_offset = 0;
+  int64_t entire_stride[kSliceMaxDims];
+  for (int i = 0; i < params.ndim; ++i) {
+    entire_offset += params.start[i] * params.stride[i];
+    entire_stride[i] = params.step[i] * params.stride[i];
+  }
+  const char* entire_ptr = static_cast<const char*>(entire) + entire_offset * elem_size;
+  auto* mlu_stream = stream->As<ep::MluStream>();
+  if (bang_strided_copy_supported(elem_size, params.ndim, entire_stride, sliced_stride)) {
+    BangHandle handle(mlu_stream->mlu_stream(), mlu_stream->device()->nclusters(),
+                      mlu_stream->device()->ncores_per_cluster());
+    bang_strided_copy_kernel(handle, elem_size, params.ndim, params.size, entire_ptr,
+                             entire_stride, sliced, sliced_stride);
+    return;
+  }
+  CnnlStridedCopy(mlu_stream, data_type, params.ndim, params.size, entire_ptr, entire_stride,
+                  sliced, sliced_stride);
+}
+
+void SliceByCnnlStridedSlice(ep::Stream* stream, const SliceParams& params, DataType data_type,
+                             const void* entire, void* sliced) {
   std::vector<int> begin(params.ndim, 0);
   std::vector<int> end(params.ndim, 0);
   std::vector<int> stride(params.ndim, 1);
@@ -52,29 +91,34 @@ void SliceKernelUtil::Forward(ep::Stream* stream, const SliceParams& params, Dat
                                  output_desc.desc(), sliced));
 }
 
-void SliceKernelUtil::Forward(ep::Stream* stream, const SliceParams& entire_params,
-                              const SliceParams& sliced_params, DataType data_type,
+}  // namespace
+
+void SliceKernelUtil::Forward(ep::Stream* stream, const SliceParams& params, DataType data_type,
                               const void* entire, void* sliced) {
-  std::vector<int> begin(entire_params.ndim, 0);
-  std::vector<int> end(entire_params.ndim, 0);
-  std::vector<int> stride(entire_params.ndim, 1);
-  for (int i = 0; i < entire_params.ndim; ++i) {
-    begin[i] = entire_params.start[i];
-    stride[i] = entire_params.step[i];
-    end[i] = (entire_params.size[i] - 1) * stride[i] + begin[i] + 1;
+  if (CanUseCnnlStridedSlice(params)) {
+    SliceByCnnlStridedSlice(stream, params, data_type, entire, sliced);
+    return;
   }
-  cnnlDataType_t cnnl_data_type = ConvertToCnnlDataType(data_type);
-  CnnlTensorDescriptor input_desc, output_desc;
+  int64_t sliced_stride[kSliceMaxDims];
+  int64_t value = 1;
+  for (int i = params.ndim - 1; i >= 0; --i) {
+    sliced_stride[i] = value;
+    value *= params.size[i];
+  }
+  SliceByStridedCopy(stream, params, data_type, entire, sliced, sliced_stride);
+}
 
+void SliceKernelUtil::Forward(ep::Stream* stream, const SliceParams& entire_params,
+                              const SliceParams& sliced_params, DataType data_type,
+                              const void* entire, void* sliced) {
   int64_t element_size = GetSizeOfDataType(data_type);
   int64_t sliced_start = 0;
-  std::vector<int64_t> sliced_stride(sliced_params.ndim);
+  int64_t sliced_stride[kSliceMaxDims];
   for (int i = 0; i < sliced_params.ndim; ++i) {
     sliced_stride[i] = sliced_params.step[i] * sliced_params.stride[i];
     sliced_start += sliced_params.start[i] * sliced_params.stride[i];
   }
-  sliced_start *= element_size;
-  output_desc.set(sliced_params.ndim, sliced_params.size, sliced_stride.data(), cnnl_data_type);
+  void* sliced_ptr = static_cast<char*>(sliced) + sliced_start * element_size;
 
   auto input_has_0_stride = [&]() {
     for (int i = 0; i < entire_params.ndim; ++i) {
@@ -83,44 +127,22 @@ void SliceKernelUtil::Forward(ep::Stream* stream, const SliceParams& entire_para
     return true;
   }();
   if (input_has_0_stride) {
+    CnnlTensorDescriptor output_desc;
+    output_desc.set(sliced_params.ndim, sliced_params.size, sliced_stride,
+                    ConvertToCnnlDataType(data_type));
     OF_CNNL_CHECK(cnnlFill_v3(stream->As<ep::MluStream>()->cnnl_handle(), CNNL_POINTER_MODE_DEVICE,
-                              entire, output_desc.desc(),
-                              reinterpret_cast<char*>(sliced) + sliced_start));
+                              entire, output_desc.desc(), sliced_ptr));
     return;
   }
 
-  CnnlWorkspace temp_entire(stream->As<ep::MluStream>(), 0);
-  const void* contiguous_entire = entire;
-  input_desc.set(entire_params.ndim, entire_params.dims, entire_params.stride, cnnl_data_type);
-  // cnnlStridedSlice does not support non-contiguous input.
-  if (!IsContiguous(entire_params.ndim, entire_params.dims, entire_params.stride)) {
-    temp_entire.resize(entire_params.elem_cnt() * element_size);
-    CnnlTensorDescriptor temp_entire_desc;
-    temp_entire_desc.set(entire_params.ndim, entire_params.size, cnnl_data_type);
-
-    OF_CNNL_CHECK(cnnlCopy(stream->As<ep::MluStream>()->cnnl_handle(), input_desc.desc(), entire,
-                           temp_entire_desc.desc(), temp_entire.dptr()));
-    contiguous_entire = temp_entire.dptr();
-    input_desc = std::move(temp_entire_desc);
-  }
-
-  // cnnlStridedSlice does not support non-contiguous output.
-  if (IsContiguous(sliced_params.ndim, sliced_params.size, sliced_stride.data())) {
-    OF_CNNL_CHECK(cnnlStridedSlice(stream->As<ep::MluStream>()->cnnl_handle(), input_desc.desc(),
-                                   contiguous_entire, begin.data(), end.data(), stride.data(),
-                                   output_desc.desc(),
-                                   reinterpret_cast<char*>(sliced) + sliced_start));
-  } else {
-    CnnlWorkspace temp(stream->As<ep::MluStream>(), sliced_params.elem_cnt() * element_size);
-    CnnlTensorDescriptor temp_desc;
-    temp_desc.set(sliced_params.ndim, sliced_params.size, cnnl_data_type);
-    OF_CNNL_CHECK(cnnlStridedSlice(stream->As<ep::MluStream>()->cnnl_handle(), input_desc.desc(),
-                                   contiguous_entire, begin.data(), end.data(), stride.data(),
-                                   temp_desc.desc(), temp.dptr()));
-    OF_CNNL_CHECK(cnnlCopy(stream->As<ep::MluStream>()->cnnl_handle(), temp_desc.desc(),
-                           temp.dptr(), output_desc.desc(),
-                           reinterpret_cast<char*>(sliced) + sliced_start));
+  // a dense slice into a dense region is a plain cnnlStridedSlice, anything strided on either
+  // side is copied straight from entire to sliced without contiguous temporaries
+  if (CanUseCnnlStridedSlice(entire_params)
+      && IsContiguous(sliced_params.ndim, sliced_params.size, sliced_stride)) {
+    SliceByCnnlStridedSlice(stream, entire_params, data_type, entire, sliced_ptr);
+    return;
   }
+  SliceByStridedCopy(stream, entire_params, data_type, entire, sliced_ptr, sliced_stride);
 }
 
 }  // namespace mlu
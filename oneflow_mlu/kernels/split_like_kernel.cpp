@@ -0,0 +1,66 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow_mlu/bang/bang_kernels.h"
+#include "oneflow_mlu/ep/mlu_stream.h"
+#include "oneflow/core/framework/framework.h"
+
+namespace oneflow {
+namespace {
+
+// Every output is a column range of the (rows, in.Count(axis)) view of in, so all of them are
+// written by one BANG launch that reads in once instead of a slice per output.
+class MluSplitLikeKernel final : public user_op::OpKernel {
+ public:
+  MluSplitLikeKernel() = default;
+  ~MluSplitLikeKernel() = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* in = ctx->Tensor4ArgNameAndIndex("in", 0);
+    const int64_t axis = ctx->Attr<int64_t>("axis");
+    const int64_t in_cols = in->shape_view().Count(axis);
+    if (in_cols == 0) { return; }
+    const int64_t rows = in->shape_view().elem_cnt() / in_cols;
+
+    const int32_t num_outputs = ctx->output_size("out");
+    std::vector<void*> outputs(num_outputs);
+    std::vector<int64_t> out_cols(num_outputs);
+    int64_t total_cols = 0;
+    for (int32_t i = 0; i < num_outputs; ++i) {
+      user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", i);
+      outputs[i] = out->mut_dptr();
+      out_cols[i] = out->shape_view().Count(axis);
+      CHECK_EQ(out->shape_view().elem_cnt(), rows * out_cols[i]);
+      total_cols += out_cols[i];
+    }
+    CHECK_LE(total_cols, in_cols);
+
+    auto* stream = ctx->stream()->As<ep::MluStream>();
+    BangHandle handle(stream->mlu_stream(), stream->device()->nclusters(),
+                      stream->device()->ncores_per_cluster());
+    bang_split_kernel(handle, GetSizeOfDataType(in->data_type()), rows, in_cols, num_outputs,
+                      outputs.data(), out_cols.data(), in->dptr());
+  }
+
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+REGISTER_USER_KERNEL("split_like")
+    .SetCreateFn<MluSplitLikeKernel>()
+    .SetIsMatchedHob(user_op::HobDeviceType() == DeviceType::kMLU);
+
+}  // namespace
+}  // namespace oneflow
@@ -34,10 +34,18 @@ class MluToContiguousKernel final : public user_op::OpKernel {
     user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
 
     CnnlTensorDescriptor input_desc, output_desc;
-    input_desc.set(in);
     output_desc.set(out);
-    OF_CNNL_CHECK(cnnlCopy(ctx->stream()->As<ep::MluStream>()->cnnl_handle(), input_desc.desc(),
-                           in->dptr(), output_desc.desc(), out->mut_dptr()));
+    auto cnnl_handle = ctx->stream()->As<ep::MluStream>()->cnnl_handle();
+    // Expanded views are materialized here, by the consumer that needs contiguous memory, as an
+    // expand of their small source rather than a copy with stride-0 reads.
+    if (input_desc.set_broadcast_source(in)) {
+      OF_CNNL_CHECK(cnnlExpand(cnnl_handle, input_desc.desc(), in->dptr(), output_desc.desc(),
+                               out->mut_dptr()));
+      return;
+    }
+    input_desc.set(in);
+    OF_CNNL_CHECK(cnnlCopy(cnnl_handle, input_desc.desc(), in->dptr(), output_desc.desc(),
+                           out->mut_dptr()));
   }
 
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
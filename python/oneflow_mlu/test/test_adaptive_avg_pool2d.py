@@ -107,6 +107,25 @@ class TestAdaptiveAvgPool2dCambriconModule(flow.unittest.TestCase):
         for arg in GenArgList(arg_dict):
             arg[0](test_case, *arg[1:])
 
+    def test_adaptive_pool2d_even_windows(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["test_fun"] = [
+            _test_adaptive_avg_pool2d_forward_backward,
+            _test_adaptive_avg_pool2d_forward_backward_channels_last,
+        ]
+        arg_dict["shape"] = [(2, 64, 7, 7), (2, 3, 32, 48)]
+        arg_dict["out_shape"] = [(2, 64, 1, 1), (2, 3, 4, 1), (2, 3, 8, 16)]
+        arg_dict["device"] = ["mlu"]
+        arg_dict["dtype"] = [
+            flow.float32,
+        ]
+        arg_dict["pooling_module"] = [
+            flow.nn.AdaptiveAvgPool2d,
+            flow.nn.AdaptiveMaxPool2d,
+        ]
+        for arg in GenArgList(arg_dict):
+            arg[0](test_case, *arg[1:])
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -65,10 +65,29 @@ class TestArange(flow.unittest.TestCase):
             flow.int8,
             flow.int32,
             flow.int64,
+            flow.float64,
         ]
         for arg in GenArgList(arg_dict):
             arg[0](test_case, *arg[1:])
 
+    def test_arange_int64_beyond_int32(test_case):
+        start = 2 ** 33 + 7
+        of_out = flow.arange(start, start + 3000, 3, device="mlu", dtype=flow.int64)
+        np_out = np.arange(start, start + 3000, 3, dtype=np.int64)
+        test_case.assertTrue(np.array_equal(of_out.numpy(), np_out))
+
+    def test_arange_float64_precision(test_case):
+        # 2 ** 27 + k / 8 is exact in double but rounds to a multiple of 16 in float
+        start = 2.0 ** 27
+        of_out = flow.arange(start, start + 64, 0.125, device="mlu", dtype=flow.float64)
+        np_out = np.arange(start, start + 64, 0.125, dtype=np.float64)
+        test_case.assertEqual(of_out.dtype, flow.float64)
+        test_case.assertTrue(np.array_equal(of_out.numpy(), np_out))
+
+        of_out = flow.arange(0.1, 100.0, 0.1, device="mlu", dtype=flow.float64)
+        np_out = np.arange(0.1, 100.0, 0.1, dtype=np.float64)
+        test_case.assertTrue(np.allclose(of_out.numpy(), np_out, 1e-12, 1e-12))
+
 
 if __name__ == "__main__":
     unittest.main()
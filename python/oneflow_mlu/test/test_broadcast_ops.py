@@ -44,3 +44,68 @@ def test_broadcast_add_forward():
     for op, shapes in itertools.product(dtypes.keys(), shape_pairs):
         for dtype in dtypes[op]:
             _test_broadcast_forward(op, *shapes, dtype)
+
+
+def _test_broadcast_int64_forward(op, shape1, shape2):
+    assert len(shape1) == len(shape2)
+    # values beyond int32 range must be computed exactly
+    x = flow.tensor(
+        np.random.randint(-(2 ** 40), 2 ** 40, size=shape1), device="cpu", dtype=flow.int64
+    )
+    y = flow.tensor(
+        np.random.randint(1, 2 ** 20, size=shape2), device="cpu", dtype=flow.int64
+    )
+    cpu_out_numpy = op(x, y).numpy()
+    x = x.to("mlu")
+    y = y.to("mlu")
+    mlu_out_numpy = op(x, y).numpy()
+    assert np.array_equal(cpu_out_numpy, mlu_out_numpy)
+
+
+def test_broadcast_int64_forward():
+    shape_pairs = zip(
+        [(2,), (2, 3), (2, 3, 4), (2, 3, 4, 5)], [(1,), (2, 1), (2, 1, 4), (2, 1, 1, 5)]
+    )
+    ops = [
+        flow.add,
+        flow.sub,
+        flow.mul,
+        flow.eq,
+        flow.ne,
+        flow.gt,
+        flow.ge,
+        flow.lt,
+        flow.le,
+    ]
+    for op, shapes in itertools.product(ops, shape_pairs):
+        _test_broadcast_int64_forward(op, *shapes)
+
+
+def test_broadcast_int64_div_forward():
+    shape_pairs = zip(
+        [(2,), (2, 3), (2, 3, 4), (2, 3, 4, 5)], [(1,), (2, 1), (2, 1, 4), (2, 1, 1, 5)]
+    )
+    for shape1, shape2 in shape_pairs:
+        x = flow.tensor(
+            np.random.randint(-(2 ** 40), 2 ** 40, size=shape1), dtype=flow.int64
+        )
+        y = flow.tensor(np.random.randint(1, 2 ** 20, size=shape2), dtype=flow.int64)
+        y = y * flow.tensor(np.random.choice([-1, 1], size=shape2), dtype=flow.int64)
+        cpu_out = flow.div(x, y)
+        mlu_out = flow.div(x.to("mlu"), y.to("mlu"))
+        assert mlu_out.dtype == cpu_out.dtype
+        assert np.allclose(cpu_out.numpy(), mlu_out.numpy(), 1e-6, 0)
+
+
+def test_broadcast_int64_div_by_zero():
+    x = np.array([[7, -7, 0], [1, 2, 3]], dtype=np.int64)
+    y = np.array([[0], [2]], dtype=np.int64)
+    mlu_out = flow.div(flow.tensor(x, device="mlu"), flow.tensor(y, device="mlu"))
+    mlu_out_numpy = mlu_out.numpy()
+    if np.issubdtype(mlu_out_numpy.dtype, np.integer):
+        # integer division truncates and gives 0 for a zero divisor, like numpy
+        expected = np.array([[0, 0, 0], [0, 1, 1]], dtype=np.int64)
+    else:
+        with np.errstate(divide="ignore", invalid="ignore"):
+            expected = x / y
+    assert np.allclose(expected, mlu_out_numpy, equal_nan=True)
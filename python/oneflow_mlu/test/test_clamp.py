@@ -33,12 +33,52 @@ def _test_clamp_max(test_case, shape, dtype, device):
     test_case.assertTrue(np.allclose(mlu_out.numpy(), cpu_out, 1e-04, 1e-04))
 
 
+def _test_clamp_min(test_case, shape, dtype, device):
+    np_arr = np.random.randn(*shape)
+    input = flow.tensor(np_arr, dtype=dtype, device=flow.device(device))
+    mlu_out = flow.clamp_min(input, -0.5)
+    cpu_out = flow.clamp_min(flow.tensor(np_arr, dtype=dtype, device="cpu"), -0.5)
+    test_case.assertTrue(np.allclose(mlu_out.numpy(), cpu_out, 1e-04, 1e-04))
+
+
+def _test_clamp(test_case, shape, dtype, device):
+    np_arr = np.random.randn(*shape)
+    input = flow.tensor(np_arr, dtype=dtype, device=flow.device(device))
+    mlu_out = flow.clamp(input, -0.5, 0.5)
+    cpu_out = flow.clamp(flow.tensor(np_arr, dtype=dtype, device="cpu"), -0.5, 0.5)
+    test_case.assertTrue(np.allclose(mlu_out.numpy(), cpu_out, 1e-04, 1e-04))
+
+
+def _test_clamp_inplace(test_case, shape, dtype, device):
+    np_arr = np.random.randn(*shape)
+    input = flow.tensor(np_arr, dtype=dtype, device=flow.device(device))
+    input.clamp_(-0.5, 0.5)
+    cpu_out = flow.clamp(flow.tensor(np_arr, dtype=dtype, device="cpu"), -0.5, 0.5)
+    test_case.assertTrue(np.allclose(input.numpy(), cpu_out, 1e-04, 1e-04))
+
+
+def _test_clamp_backward(test_case, shape, device):
+    np_arr = np.random.randn(*shape)
+    np_dy = np.random.randn(*shape)
+    for min, max in [(-0.5, 0.5), (-0.5, None), (None, 0.5)]:
+        grads = []
+        for d in [device, "cpu"]:
+            x = flow.tensor(np_arr, dtype=flow.float32, device=d, requires_grad=True)
+            y = flow.clamp(x, min, max)
+            y.backward(flow.tensor(np_dy, dtype=flow.float32, device=d))
+            grads.append(x.grad.numpy())
+        test_case.assertTrue(np.allclose(grads[0], grads[1], 1e-04, 1e-04))
+
+
 @flow.unittest.skip_unless_1n1d()
 class TestClampCambriconModule(flow.unittest.TestCase):
     def test_gelu(test_case):
         arg_dict = OrderedDict()
         arg_dict["test_fun"] = [
             _test_clamp_max,
+            _test_clamp_min,
+            _test_clamp,
+            _test_clamp_inplace,
         ]
         arg_dict["shape"] = [(2,), (2, 3), (2, 4, 5, 6)]
         arg_dict["dtype"] = [flow.float32, flow.int32]
@@ -46,6 +86,13 @@ class TestClampCambriconModule(flow.unittest.TestCase):
         for arg in GenArgList(arg_dict):
             arg[0](test_case, *arg[1:])
 
+    def test_clamp_backward(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["shape"] = [(2, 3), (2, 4, 5, 6)]
+        arg_dict["device"] = ["mlu"]
+        for arg in GenArgList(arg_dict):
+            _test_clamp_backward(test_case, *arg)
+
 
 if __name__ == "__main__":
     unittest.main()
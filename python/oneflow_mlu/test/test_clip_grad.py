@@ -13,6 +13,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 """
+
 import os
 import unittest
 from collections import OrderedDict
@@ -48,7 +49,9 @@ def _clip_grad_norm_np(input, max_norm, norm_type):
     return total_norm, np_grad
 
 
-def _test_clip_grad_norm_impl(test_case, shape, device, max_norm, norm_type):
+def _test_clip_grad_norm_impl(
+    test_case, shape, device, max_norm, norm_type, fused=False
+):
     np_input = np.random.rand(*shape)
     of_input = flow.tensor(
         np_input, dtype=flow.float32, device=flow.device(device), requires_grad=True
@@ -57,7 +60,12 @@ def _test_clip_grad_norm_impl(test_case, shape, device, max_norm, norm_type):
     of_out = m(of_input)
     of_out = of_out.sum()
     of_out.backward()
-    of_total_norm = flow.nn.utils.clip_grad_norm_(of_input, max_norm, norm_type)
+    if fused:
+        of_total_norm = flow.nn.utils.clip_grad_norm_(
+            of_input, max_norm, norm_type, fused=True
+        )
+    else:
+        of_total_norm = flow.nn.utils.clip_grad_norm_(of_input, max_norm, norm_type)
     np_total_norm, np_grad = _clip_grad_norm_np(np_input, max_norm, norm_type)
     test_case.assertTrue(
         np.allclose(of_total_norm.numpy(), np_total_norm, 1e-4, 1e-4, equal_nan=True)
@@ -79,6 +87,16 @@ class TestMluClipGrad(flow.unittest.TestCase):
         for arg in GenArgList(arg_dict):
             _test_clip_grad_norm_impl(test_case, *arg)
 
+    @unittest.skipUnless(hasattr(flow._C, "fused_clip_grad"), "no fused_clip_grad")
+    def test_fused_clip_grad(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["shape"] = [(2, 3), (2, 3, 4), (2, 4, 5, 6), (1024, 1025)]
+        arg_dict["device"] = ["mlu"]
+        arg_dict["max_norm"] = [0, 0.5, 1.0, 1e6]
+        arg_dict["norm_type"] = ["inf", 1.0, 2.0, 3.5]
+        for arg in GenArgList(arg_dict):
+            _test_clip_grad_norm_impl(test_case, *arg, fused=True)
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -168,6 +168,27 @@ class TestCnclCambriconModule(flow.unittest.TestCase):
 
         test_case.assertTrue(np.array_equal(eager_out.to_local().numpy(), arr_out))
 
+    def test_cncl_send_recv_reuses_group(test_case):
+        # the broadcast creates the eager communicator of both devices, send and recv
+        # between the two processes then go over that group communicator
+        arr = np.arange(24, dtype=np.float32).reshape(4, 6)
+        x = flow.tensor(arr, device="mlu").to_global(
+            placement=flow.env.all_device_placement("mlu"), sbp=flow.sbp.split(0)
+        )
+        y = x.to_global(
+            placement=flow.env.all_device_placement("mlu"), sbp=flow.sbp.broadcast
+        )
+        test_case.assertTrue(np.array_equal(y.to_local().numpy(), arr))
+
+        for src, dst in [(0, 1), (1, 0)]:
+            if flow.env.get_rank() == src:
+                flow.comm.send(flow.tensor(arr * (src + 1), device="mlu"), dst)
+            else:
+                out = flow.comm.recv(
+                    src, shape=arr.shape, dtype=flow.float32, device="mlu"
+                )
+                test_case.assertTrue(np.array_equal(out.numpy(), arr * (src + 1)))
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -0,0 +1,62 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import unittest
+
+import numpy as np
+
+import oneflow_mlu
+import oneflow as flow
+import oneflow.unittest
+
+
+# Tensor descriptors are recycled through a per-thread pool and skip CNNL when the
+# same layout, dtype, shape and stride are set again. These run kernels back to back
+# so pooled descriptors are reused with the same shape under another dtype or stride.
+@flow.unittest.skip_unless_1n1d()
+class TestCnnlTensorDescriptor(flow.unittest.TestCase):
+    def test_reuse_with_changing_dtype(test_case):
+        shape = (4, 6)
+        for dtype in [flow.float32, flow.float16, flow.int32, flow.float32] * 2:
+            x = np.random.randint(-8, 8, size=shape)
+            y = np.random.randint(-8, 8, size=shape)
+            mlu_x = flow.tensor(x, device="mlu", dtype=dtype)
+            mlu_y = flow.tensor(y, device="mlu", dtype=dtype)
+            out = flow.add(mlu_x, mlu_y)
+            test_case.assertEqual(out.dtype, dtype)
+            test_case.assertTrue(np.array_equal(out.numpy().astype(np.int64), x + y))
+
+    def test_reuse_with_changing_stride(test_case):
+        for transpose in [False, True, False, True]:
+            arr = np.random.randn(6, 6).astype(np.float32)
+            x = flow.tensor(arr, device="mlu")
+            if transpose:
+                x = x.transpose(0, 1)
+                arr = arr.T
+            out = x.contiguous() * 2
+            test_case.assertTrue(np.allclose(out.numpy(), arr * 2, 1e-5, 1e-5))
+
+    def test_reuse_with_changing_shape(test_case):
+        for i in range(80):
+            shape = (i % 5 + 1, i % 7 + 1, 3)
+            arr = np.random.randn(*shape).astype(np.float32)
+            out = flow.relu(flow.tensor(arr, device="mlu"))
+            test_case.assertEqual(out.shape, flow.Size(shape))
+            test_case.assertTrue(np.allclose(out.numpy(), np.maximum(arr, 0)))
+
+
+if __name__ == "__main__":
+    unittest.main()
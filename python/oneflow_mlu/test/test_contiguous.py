@@ -45,12 +45,41 @@ def _test_contiguous_forward(test_case, device, dtype):
     test_case.assertTrue(np.allclose(z.cpu().numpy(), z_cpu.numpy()))
 
 
+def _test_contiguous_expanded(test_case, device, dtype):
+    for shape, expand_shape in [
+        ((3, 1), (3, 4)),
+        ((1, 4), (2, 3, 4)),
+        ((2, 1, 4), (2, 5, 4)),
+        ((1, 1), (4, 6)),
+    ]:
+        x = flow.tensor(
+            np.random.randn(*shape), device=flow.device(device), dtype=dtype
+        )
+        y = x.expand(*expand_shape)
+        # a stride-0 view of a contiguous source takes the cnnlExpand path
+        test_case.assertFalse(y.is_contiguous())
+        test_case.assertIn(0, y.stride())
+        z = y.contiguous()
+        test_case.assertTrue(z.is_contiguous())
+        z_cpu = x.cpu().expand(*expand_shape).contiguous()
+        test_case.assertTrue(np.array_equal(z.cpu().numpy(), z_cpu.numpy()))
+
+    # the source of this view is not contiguous, it is copied with stride-0 reads
+    x = flow.tensor(np.random.randn(4, 3, 1), device=flow.device(device), dtype=dtype)
+    y = x.permute(1, 0, 2).expand(3, 4, 5)
+    test_case.assertIn(0, y.stride())
+    z = y.contiguous()
+    z_cpu = x.cpu().permute(1, 0, 2).expand(3, 4, 5).contiguous()
+    test_case.assertTrue(np.array_equal(z.cpu().numpy(), z_cpu.numpy()))
+
+
 @flow.unittest.skip_unless_1n1d()
 class TestContiguousCambriconModule(flow.unittest.TestCase):
     def test_contiguous(test_case):
         arg_dict = OrderedDict()
         arg_dict["test_fun"] = [
             _test_contiguous_forward,
+            _test_contiguous_expanded,
         ]
         arg_dict["device"] = ["mlu"]
         arg_dict["dtype"] = [
@@ -0,0 +1,65 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import unittest
+import oneflow_mlu
+import oneflow as flow
+import oneflow.unittest
+import numpy as np
+
+
+def _test_arange(test_case, placement, sbp, start, end, step, dtype, np_dtype):
+    # a non-zero start makes the second shard depend on its offset into the range
+    of_out = flow.arange(start, end, step, placement=placement, sbp=sbp, dtype=dtype)
+    np_out = np.arange(start, end, step, dtype=np_dtype)
+    test_case.assertTrue(np.allclose(of_out.numpy(), np_out, 1e-05, 1e-05))
+
+
+@flow.unittest.skip_unless_1n2d()
+class TestArangeModule(flow.unittest.TestCase):
+    def test_arange(test_case):
+        placement = flow.placement("mlu", [0, 1])
+        float_dtypes = [(flow.float32, np.float32), (flow.float64, np.float64)]
+        int_dtypes = [
+            (flow.int8, np.int8),
+            (flow.int32, np.int32),
+            (flow.int64, np.int64),
+        ]
+        for sbp in (flow.sbp.broadcast, flow.sbp.split(0)):
+            for dtype, np_dtype in float_dtypes:
+                _test_arange(
+                    test_case, placement, sbp, 1.5, 33.5, 0.25, dtype, np_dtype
+                )
+            for dtype, np_dtype in int_dtypes:
+                _test_arange(test_case, placement, sbp, 3, 103, 2, dtype, np_dtype)
+
+    def test_arange_int64_beyond_int32(test_case):
+        placement = flow.placement("mlu", [0, 1])
+        start = 2 ** 33 + 7
+        _test_arange(
+            test_case,
+            placement,
+            flow.sbp.split(0),
+            start,
+            start + 3000,
+            3,
+            flow.int64,
+            np.int64,
+        )
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,49 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import unittest
+
+import numpy as np
+
+import oneflow_mlu
+import oneflow as flow
+import oneflow.unittest
+
+
+# 2 ** 31 + 16 int8 elements, offsets past the last element that fits in int
+_NUM_ROWS = 2 ** 30 + 8
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestLargeTensor(flow.unittest.TestCase):
+    def test_slice_beyond_int32_offset(test_case):
+        x = flow.ones((_NUM_ROWS, 2), dtype=flow.int8, device="mlu")
+        x[-1:, :] = 3
+        test_case.assertTrue(np.array_equal(x[-4:, 1].numpy(), [1, 1, 1, 3]))
+        test_case.assertTrue(np.array_equal(x[:2, 0].numpy(), [1, 1]))
+
+    def test_contiguous_with_large_extent(test_case):
+        x = flow.ones((_NUM_ROWS, 2), dtype=flow.int8, device="mlu")
+        x[-1:, 1] = 5
+        # stride (1, 2) over 2 ** 31 + 16 elements
+        y = x.t().contiguous()
+        test_case.assertEqual(y.shape, flow.Size((2, _NUM_ROWS)))
+        test_case.assertTrue(np.array_equal(y[:, -2:].numpy(), [[1, 1], [1, 5]]))
+        test_case.assertTrue(np.array_equal(y[:, :2].numpy(), [[1, 1], [1, 1]]))
+
+
+if __name__ == "__main__":
+    unittest.main()
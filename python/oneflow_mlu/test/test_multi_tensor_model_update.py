@@ -0,0 +1,162 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import unittest
+
+import numpy as np
+
+import oneflow_mlu
+import oneflow as flow
+import oneflow.unittest
+
+
+def _make_param_arrays():
+    shapes = [(4, 100, 200, 10), (23333,), (1,), (1, 10), (0,), (7, 3)]
+    return [
+        (
+            np.random.randn(*shape).astype(np.float32),
+            np.random.randn(*shape).astype(np.float32),
+        )
+        for shape in shapes
+    ]
+
+
+def _make_params(arrays, device):
+    params = []
+    for np_model, np_model_diff in arrays:
+        param = flow.nn.Parameter(flow.tensor(np_model).to(device))
+        param.grad = flow.tensor(np_model_diff).to(device)
+        params.append(param)
+    return params
+
+
+# Trains an amp graph whose fused multi-tensor update also writes the fp16 model_copy
+# that the next forward reads, or the per-tensor update and cast as the reference.
+def _train_amp_graph(np_weight, np_input, fuse_cast, steps=3):
+    class Model(flow.nn.Module):
+        def __init__(self):
+            super().__init__()
+            self.weight = flow.nn.Parameter(flow.tensor(np_weight, device="mlu"))
+
+        def forward(self, input):
+            return (flow.matmul(input, self.weight) ** 2).mean()
+
+    model = Model()
+    optimizer = flow.optim.SGD(model.parameters(), lr=0.01, momentum=0.9)
+
+    class TrainGraph(flow.nn.Graph):
+        def __init__(self):
+            super().__init__()
+            self.model = model
+            self.add_optimizer(optimizer)
+            self.config.enable_amp(True)
+            if fuse_cast:
+                self.config.enable_multi_tensor_update(True)
+                self.config.enable_fuse_model_update_cast(True)
+
+        def build(self, input):
+            loss = self.model(input)
+            loss.backward()
+            return loss
+
+    graph = TrainGraph()
+    input = flow.tensor(np_input, device="mlu")
+    losses = [graph(input).numpy() for _ in range(steps)]
+    return losses, model.weight.numpy()
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestMluMultiTensorModelUpdate(flow.unittest.TestCase):
+    def _compare(test_case, make_optimizer, steps=2):
+        def get_updated_tensors(device):
+            params = _make_params(arrays, device)
+            optimizer = make_optimizer(params)
+            for _ in range(steps):
+                optimizer.step()
+            return params
+
+        arrays = _make_param_arrays()
+        cpu_tensors = get_updated_tensors("cpu")
+        mlu_tensors = get_updated_tensors("mlu")
+        for cpu, mlu in zip(cpu_tensors, mlu_tensors):
+            test_case.assertTrue(
+                np.allclose(cpu.numpy(), mlu.numpy(), rtol=1e-4, atol=1e-5)
+            )
+
+    def test_multi_tensor_sgd_update(test_case):
+        test_case._compare(
+            lambda params: flow.optim.SGD(
+                params, lr=0.001, weight_decay=0.01, fused=True
+            )
+        )
+
+    def test_multi_tensor_momentum_update(test_case):
+        test_case._compare(
+            lambda params: flow.optim.SGD(params, lr=0.001, momentum=0.9, fused=True)
+        )
+        test_case._compare(
+            lambda params: flow.optim.SGD(
+                params, lr=0.001, momentum=0.9, nesterov=True, fused=True
+            )
+        )
+
+    def test_multi_tensor_adam_update(test_case):
+        test_case._compare(
+            lambda params: flow.optim.Adam(
+                params, lr=0.001, weight_decay=0.01, fused=True
+            )
+        )
+        test_case._compare(
+            lambda params: flow.optim.AdamW(
+                params, lr=0.001, do_bias_correction=False, fused=True
+            )
+        )
+
+    def test_multi_tensor_sgd_update_half_model_diff(test_case):
+        learning_rate = 0.001
+        weight_decay = 0.01
+        models, model_diffs, expected = [], [], []
+        for shape in [(4, 100, 200, 10), (23333,), (1,), (7, 3)]:
+            np_model = np.random.randn(*shape).astype(np.float32)
+            np_model_diff = np.random.randn(*shape).astype(np.float16)
+            models.append(flow.tensor(np_model, device="mlu"))
+            model_diffs.append(flow.tensor(np_model_diff, device="mlu"))
+            expected.append(
+                np_model
+                - learning_rate
+                * (np_model_diff.astype(np.float32) + weight_decay * np_model)
+            )
+        flow._C.multi_tensor_sgd_update(
+            models, model_diffs, 1.0, weight_decay, learning_rate
+        )
+        for model, np_expected in zip(models, expected):
+            test_case.assertTrue(
+                np.allclose(model.numpy(), np_expected, rtol=1e-4, atol=1e-5)
+            )
+
+    def test_multi_tensor_momentum_update_with_cast(test_case):
+        np_weight = np.random.randn(64, 48).astype(np.float32) * 0.1
+        np_input = np.random.randn(16, 64).astype(np.float32)
+        losses, weight = _train_amp_graph(np_weight, np_input, fuse_cast=True)
+        ref_losses, ref_weight = _train_amp_graph(np_weight, np_input, fuse_cast=False)
+        # every loss after the first reads the model_copy of the previous step
+        for loss, ref_loss in zip(losses, ref_losses):
+            test_case.assertTrue(np.allclose(loss, ref_loss, rtol=1e-3, atol=1e-3))
+        test_case.assertTrue(np.allclose(weight, ref_weight, rtol=1e-3, atol=1e-3))
+
+
+if __name__ == "__main__":
+    unittest.main()
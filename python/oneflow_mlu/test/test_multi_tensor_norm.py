@@ -0,0 +1,84 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import unittest
+from collections import OrderedDict
+
+import numpy as np
+from oneflow.test_utils.test_util import GenArgList
+
+import oneflow_mlu
+import oneflow as flow
+import oneflow.unittest
+
+
+# the sums stay below the float16 max for every p tested
+_SHAPES = [(2, 3), (1025,), (1,), (0,), (16, 1024, 3)]
+
+
+def _make_arrays(np_dtype):
+    return [np.random.uniform(-1, 1, size=shape).astype(np_dtype) for shape in _SHAPES]
+
+
+def _test_multi_reduce_sum_pow_abs(test_case, dtype, p):
+    np_dtype = np.float16 if dtype == flow.float16 else np.float32
+    arrays = _make_arrays(np_dtype)
+    inputs = [flow.tensor(arr, device="mlu", dtype=dtype) for arr in arrays]
+    out = flow._C.multi_reduce_sum_pow_abs(inputs, p)
+    # accumulated in float on the device whatever the input type
+    np_out = sum(
+        np.sum(np.abs(arr.astype(np.float64)) ** p) if p != 0 else np.count_nonzero(arr)
+        for arr in arrays
+    )
+    test_case.assertEqual(out.dtype, dtype)
+    rtol = 1e-2 if dtype == flow.float16 else 1e-4
+    test_case.assertTrue(np.allclose(out.numpy(), np_out, rtol, rtol))
+
+
+def _test_multi_count_not_finite(test_case, dtype):
+    np_dtype = np.float16 if dtype == flow.float16 else np.float32
+    arrays = _make_arrays(np_dtype)
+    inputs = [flow.tensor(arr, device="mlu", dtype=dtype) for arr in arrays]
+    out = flow._C.multi_count_not_finite(inputs)
+    test_case.assertEqual(out.numpy().item(), 0)
+
+    arrays[0][1, 2] = np.inf
+    arrays[1][1024] = -np.inf
+    arrays[2][0] = np.nan
+    arrays[4][15, 1023, 2] = np.nan
+    arrays[4][0, 0, 0] = np.inf
+    inputs = [flow.tensor(arr, device="mlu", dtype=dtype) for arr in arrays]
+    out = flow._C.multi_count_not_finite(inputs)
+    test_case.assertEqual(out.dtype, flow.int64)
+    test_case.assertEqual(out.numpy().item(), 5)
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestMultiTensorNorm(flow.unittest.TestCase):
+    def test_multi_reduce_sum_pow_abs(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["dtype"] = [flow.float32, flow.float16]
+        arg_dict["p"] = [0.0, 1.0, 2.0, 3.5]
+        for arg in GenArgList(arg_dict):
+            _test_multi_reduce_sum_pow_abs(test_case, *arg)
+
+    def test_multi_count_not_finite(test_case):
+        for dtype in [flow.float32, flow.float16]:
+            _test_multi_count_not_finite(test_case, dtype)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -161,6 +161,47 @@ class TestNLLLossCambriconModule(flow.unittest.TestCase):
         for arg in GenArgList(arg_dict):
             arg[0](test_case, *arg[1:])
 
+    def test_nll_loss_ignore_index(test_case):
+        x = np.random.randn(64, 10).astype(np.float32)
+        target = np.random.randint(0, 10, size=(64,)).astype(np.int64)
+        target[::3] = 4
+        weight = np.random.rand(10).astype(np.float32)
+        for reduction in ["mean", "sum", "none"]:
+            outs = []
+            for device in ["cpu", "mlu"]:
+                nll = flow.nn.NLLLoss(
+                    weight=flow.tensor(weight, device=device),
+                    ignore_index=4,
+                    reduction=reduction,
+                )
+                outs.append(
+                    nll(
+                        flow.tensor(x, device=device), flow.tensor(target, device=device)
+                    ).numpy()
+                )
+            test_case.assertTrue(np.allclose(outs[0], outs[1], 0.0001, 0.0001))
+
+    def test_nll_loss_ignore_index_backward(test_case):
+        x = np.random.randn(64, 10).astype(np.float32)
+        target = np.random.randint(0, 10, size=(64,)).astype(np.int64)
+        target[::3] = -100
+        weight = np.random.rand(10).astype(np.float32)
+        for reduction in ["sum", "none"]:
+            grads = []
+            for device in ["cpu", "mlu"]:
+                input = flow.tensor(x, device=device, requires_grad=True)
+                nll = flow.nn.NLLLoss(
+                    weight=flow.tensor(weight, device=device),
+                    ignore_index=-100,
+                    reduction=reduction,
+                )
+                out = nll(input, flow.tensor(target, device=device))
+                out.sum().backward()
+                grads.append(input.grad.numpy())
+            test_case.assertTrue(np.allclose(grads[0], grads[1], 0.0001, 0.0001))
+            # ignored samples get no gradient
+            test_case.assertTrue(np.all(grads[1][::3] == 0))
+
 
 if __name__ == "__main__":
     unittest.main()
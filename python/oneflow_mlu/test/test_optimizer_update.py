@@ -0,0 +1,143 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import unittest
+from unittest import mock
+
+import numpy as np
+
+import oneflow_mlu
+import oneflow as flow
+import oneflow.unittest
+
+
+# Wraps an optimizer's flow._C.dispatch_*_update so that model_diff reaches the
+# kernel as float16 while model and states stay float32.
+def _dispatch_with_half_model_diff(dispatch):
+    def dispatch_half(op, inputs, **kwargs):
+        inputs = list(inputs)
+        inputs[1] = inputs[1].to(flow.float16)
+        return dispatch(op, tuple(inputs), **kwargs)
+
+    return dispatch_half
+
+
+def _get_updated_tensors(device, make_optimizer, half_model_diff, steps=3):
+    np.random.seed(0)
+    params = []
+    for shape in [(4, 100, 200, 10), (23333,), (1,), (1, 10)]:
+        params.append(
+            flow.nn.Parameter(
+                flow.tensor(np.random.uniform(-1, 1, size=shape).astype(np.float32)).to(
+                    device
+                )
+            )
+        )
+    grads = [np.random.uniform(-1, 1, size=p.shape).astype(np.float32) for p in params]
+    if half_model_diff:
+        # the float32 reference sees exactly the values the float16 model_diff holds
+        grads = [grad.astype(np.float16).astype(np.float32) for grad in grads]
+    optimizer = make_optimizer(params)
+    for _ in range(steps):
+        for param, grad in zip(params, grads):
+            param.grad = flow.tensor(grad).to(device)
+        optimizer.step()
+    return params
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestMluOptimizerUpdate(flow.unittest.TestCase):
+    def _compare(test_case, make_optimizer, half_model_diff_dispatch=None):
+        half_model_diff = half_model_diff_dispatch is not None
+        cpu_tensors = _get_updated_tensors("cpu", make_optimizer, half_model_diff)
+        if half_model_diff:
+            dispatch = getattr(flow._C, half_model_diff_dispatch)
+            with mock.patch.object(
+                flow._C,
+                half_model_diff_dispatch,
+                _dispatch_with_half_model_diff(dispatch),
+            ):
+                mlu_tensors = _get_updated_tensors("mlu", make_optimizer, True)
+        else:
+            mlu_tensors = _get_updated_tensors("mlu", make_optimizer, False)
+        for cpu, mlu in zip(cpu_tensors, mlu_tensors):
+            test_case.assertTrue(
+                np.allclose(cpu.numpy(), mlu.numpy(), rtol=1e-4, atol=1e-5)
+            )
+
+    def test_mlu_lamb_update(test_case):
+        test_case._compare(
+            lambda params: flow.optim.LAMB(params, lr=0.001, weight_decay=0.01)
+        )
+        test_case._compare(
+            lambda params: flow.optim.LAMB(params, lr=0.001, do_bias_correction=False)
+        )
+
+    def test_mlu_adagrad_update(test_case):
+        test_case._compare(
+            lambda params: flow.optim.Adagrad(
+                params, lr=0.01, lr_decay=0.1, weight_decay=0.01
+            )
+        )
+        test_case._compare(
+            lambda params: flow.optim.Adagrad(
+                params, lr=0.01, initial_accumulator_value=0.1
+            )
+        )
+
+    def test_mlu_rmsprop_update(test_case):
+        test_case._compare(
+            lambda params: flow.optim.RMSprop(params, lr=0.01, alpha=0.9)
+        )
+        test_case._compare(
+            lambda params: flow.optim.RMSprop(params, lr=0.01, alpha=0.9, centered=True)
+        )
+
+    def test_mlu_ftrl_update(test_case):
+        # the dense FTRL optimizer lives in one_embedding, it updates parameters
+        # through the same ftrl_update op
+        test_case._compare(
+            lambda params: flow.one_embedding.Ftrl(
+                params, lr=0.1, lr_power=-0.5, lambda1=0.01, lambda2=0.01, beta=1.0
+            )
+        )
+        test_case._compare(
+            lambda params: flow.one_embedding.Ftrl(
+                params, lr=0.1, weight_decay=0.01, initial_accumulator_value=0.5
+            )
+        )
+
+    def test_mlu_update_half_model_diff(test_case):
+        test_case._compare(
+            lambda params: flow.optim.LAMB(params, lr=0.001, weight_decay=0.01),
+            "dispatch_lamb_update",
+        )
+        test_case._compare(
+            lambda params: flow.optim.Adagrad(params, lr=0.01, lr_decay=0.1),
+            "dispatch_adagrad_update",
+        )
+        test_case._compare(
+            lambda params: flow.optim.RMSprop(params, lr=0.01, centered=True),
+            "dispatch_rmsprop_update",
+        )
+        test_case._compare(
+            lambda params: flow.one_embedding.Ftrl(params, lr=0.1, lambda1=0.01),
+            "dispatch_ftrl_update",
+        )
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,120 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import unittest
+
+import numpy as np
+
+import oneflow_mlu
+import oneflow as flow
+import oneflow.unittest
+
+
+# Forward and backward of a max or avg pooling function on MLU against CPU.
+def _test_pool_nd(test_case, pool, shape, kwargs, dtype):
+    x = np.random.randn(*shape)
+    mlu_x = flow.tensor(x, device=flow.device("mlu"), dtype=dtype, requires_grad=True)
+    # the reference sees the values as rounded to dtype, so near ties pick the same max
+    cpu_x = mlu_x.detach().cpu().float().requires_grad_()
+    mlu_y = pool(mlu_x, **kwargs)
+    cpu_y = pool(cpu_x, **kwargs)
+    y_grad = flow.tensor(
+        np.random.randn(*cpu_y.shape), device=flow.device("mlu"), dtype=dtype
+    )
+    mlu_y.backward(y_grad)
+    cpu_y.backward(y_grad.cpu().float())
+    tol = 0.001 if dtype == flow.float16 else 0.0001
+    test_case.assertTrue(
+        np.allclose(mlu_y.cpu().float().numpy(), cpu_y.numpy(), tol, tol)
+    )
+    test_case.assertTrue(
+        np.allclose(mlu_x.grad.cpu().float().numpy(), cpu_x.grad.numpy(), tol, tol)
+    )
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestPoolNdCambriconModule(flow.unittest.TestCase):
+    def test_max_pool1d(test_case):
+        for dtype in [flow.float32, flow.float16]:
+            for ceil_mode in [True, False]:
+                _test_pool_nd(
+                    test_case,
+                    flow.nn.functional.max_pool1d,
+                    (2, 4, 33),
+                    {
+                        "kernel_size": 3,
+                        "stride": 2,
+                        "padding": 1,
+                        "ceil_mode": ceil_mode,
+                    },
+                    dtype,
+                )
+
+    def test_max_pool3d(test_case):
+        for dtype in [flow.float32, flow.float16]:
+            _test_pool_nd(
+                test_case,
+                flow.nn.functional.max_pool3d,
+                (2, 3, 6, 10, 12),
+                {"kernel_size": (2, 3, 3), "stride": (1, 2, 2), "padding": (1, 1, 0)},
+                dtype,
+            )
+
+    def test_avg_pool1d(test_case):
+        for dtype in [flow.float32, flow.float16]:
+            for count_include_pad in [True, False]:
+                _test_pool_nd(
+                    test_case,
+                    flow.nn.functional.avg_pool1d,
+                    (2, 4, 33),
+                    {
+                        "kernel_size": 3,
+                        "stride": 2,
+                        "padding": 1,
+                        "count_include_pad": count_include_pad,
+                    },
+                    dtype,
+                )
+
+    def test_avg_pool3d(test_case):
+        for dtype in [flow.float32, flow.float16]:
+            for divisor_override in [None, 5]:
+                _test_pool_nd(
+                    test_case,
+                    flow.nn.functional.avg_pool3d,
+                    (2, 3, 6, 10, 12),
+                    {
+                        "kernel_size": (2, 3, 3),
+                        "stride": (1, 2, 2),
+                        "padding": (1, 1, 0),
+                        "divisor_override": divisor_override,
+                    },
+                    dtype,
+                )
+
+    def test_avg_pool2d_divisor_override(test_case):
+        for dtype in [flow.float32, flow.float16]:
+            _test_pool_nd(
+                test_case,
+                flow.nn.functional.avg_pool2d,
+                (2, 3, 24, 24),
+                {"kernel_size": 3, "stride": 2, "padding": 1, "divisor_override": 4},
+                dtype,
+            )
+
+
+if __name__ == "__main__":
+    unittest.main()
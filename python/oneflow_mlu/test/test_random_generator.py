@@ -0,0 +1,65 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import unittest
+
+import numpy as np
+
+import oneflow_mlu
+import oneflow as flow
+import oneflow.unittest
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestMluRandomGenerator(flow.unittest.TestCase):
+    def test_state_round_trip(test_case):
+        gen = flow.Generator(device="mlu")
+        gen.manual_seed(1234)
+        test_case.assertEqual(gen.get_state().numel(), 16)
+        state = gen.get_state()
+        a = flow.randn(1000, device="mlu", generator=gen).numpy()
+        b = flow.randn(1000, device="mlu", generator=gen).numpy()
+        test_case.assertFalse(np.array_equal(a, b))
+        gen.set_state(state)
+        c = flow.randn(1000, device="mlu", generator=gen).numpy()
+        test_case.assertTrue(np.array_equal(a, c))
+
+    def test_normal_moments(test_case):
+        gen = flow.Generator(device="mlu")
+        gen.manual_seed(0)
+        x = flow.normal(2.0, 3.0, (1024, 1023), device="mlu", generator=gen).numpy()
+        test_case.assertTrue(np.isfinite(x).all())
+        test_case.assertTrue(abs(x.mean() - 2.0) < 0.05)
+        test_case.assertTrue(abs(x.std() - 3.0) < 0.05)
+
+    def test_uniform_range(test_case):
+        gen = flow.Generator(device="mlu")
+        gen.manual_seed(0)
+        x = flow.rand(1024, 1023, device="mlu", generator=gen).numpy()
+        test_case.assertTrue((x >= 0).all() and (x < 1).all())
+        test_case.assertTrue(abs(x.mean() - 0.5) < 0.01)
+
+    def test_dropout_mask(test_case):
+        flow.manual_seed(0)
+        x = flow.ones(1024, 1023, device="mlu")
+        y = flow._C.dropout(x, p=0.3).numpy()
+        kept = y != 0
+        test_case.assertTrue(abs(kept.mean() - 0.7) < 0.01)
+        test_case.assertTrue(np.allclose(y[kept], 1 / 0.7))
+
+
+if __name__ == "__main__":
+    unittest.main()
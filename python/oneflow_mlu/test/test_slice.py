@@ -139,6 +139,16 @@ def _test_slice_graph(test_case, device):
     test_case.assertTrue(np.array_equal(out.cpu().numpy(), np_arr[0, ::1, ..., 2:3]))
 
 
+def _test_slice_non_contiguous_input(test_case, device):
+    np_arr = np.random.randn(4, 5, 6, 7).astype(np.float32)
+    x = flow.tensor(np_arr, device=flow.device(device)).permute(0, 3, 1, 2)
+    np_x = np_arr.transpose(0, 3, 1, 2)
+    test_case.assertTrue(
+        np.array_equal(x[1:3, ::2, :, 1:5].numpy(), np_x[1:3, ::2, :, 1:5])
+    )
+    test_case.assertTrue(np.array_equal(x[:, 2, ::3].numpy(), np_x[:, 2, ::3]))
+
+
 @flow.unittest.skip_unless_1n1d()
 class TestSlice(flow.unittest.TestCase):
     def test_slice(test_case):
@@ -153,6 +163,7 @@ class TestSlice(flow.unittest.TestCase):
             _test_slice_negative_index,
             _test_slice_ellipsis_type,
             _test_slice_graph,
+            _test_slice_non_contiguous_input,
         ]
         arg_dict["device"] = ["mlu"]
         for arg in GenArgList(arg_dict):
@@ -276,6 +287,28 @@ class TestSliceUpdate(flow.unittest.TestCase):
                 inv_perm[perm[i]] = i
             return no_perm_shape, inv_perm
 
+    def test_slice_update_non_contiguous_value(test_case):
+        ref_np = np.random.rand(4, 6, 8).astype(np.float32)
+        update_np = np.random.rand(4, 3, 2).astype(np.float32)
+        ref_of = flow.tensor(ref_np).to("mlu")
+        update_of = flow.tensor(update_np.transpose(2, 1, 0).copy()).to("mlu")
+        ref_of[:, 1:6:2, 3:7:2] = update_of.permute(2, 1, 0)
+        ref_np[:, 1:6:2, 3:7:2] = update_np
+        test_case.assertTrue(np.array_equal(ref_of.cpu().numpy(), ref_np))
+
+    def test_slice_update_many_short_and_long_rows(test_case):
+        # short rows are moved many per DMA, rows longer than a tile are split
+        for shape, index in [
+            ((64, 3000, 16), (slice(None), slice(None), slice(4, 9))),
+            ((3, 5, 300000), (slice(None), slice(1, 4), slice(1, None))),
+        ]:
+            ref_np = np.random.rand(*shape).astype(np.float32)
+            update_np = np.random.rand(*ref_np[index].shape).astype(np.float32)
+            ref_of = flow.tensor(ref_np).to("mlu")
+            ref_of[index] = flow.tensor(update_np).to("mlu")
+            ref_np[index] = update_np
+            test_case.assertTrue(np.array_equal(ref_of.cpu().numpy(), ref_np))
+
     def test_slice_update_expand_value(test_case):
         ref_np = np.random.rand(2, 3, 4)
         ref_of = flow.tensor(ref_np).to("mlu")
@@ -0,0 +1,62 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import unittest
+from collections import OrderedDict
+
+import numpy as np
+from oneflow.test_utils.test_util import GenArgList
+
+import oneflow_mlu
+import oneflow as flow
+import oneflow.unittest
+
+
+def _test_split_like(test_case, shape, axis, sizes, device, dtype):
+    np_arr = np.random.randn(*shape)
+    x = flow.tensor(np_arr, device=flow.device(device), dtype=dtype)
+    like = []
+    for size in sizes:
+        like_shape = list(shape)
+        like_shape[axis] = size
+        like.append(flow.empty(*like_shape, device=flow.device(device), dtype=dtype))
+    outs = flow._C.split_like(x, like=like, axis=axis)
+    np_outs = np.split(np_arr, np.cumsum(sizes)[:-1], axis=axis)
+    test_case.assertEqual(len(outs), len(sizes))
+    for out, np_out in zip(outs, np_outs):
+        test_case.assertTrue(np.allclose(out.numpy(), np_out, 0.0001, 0.0001))
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestSplitLikeCambriconModule(flow.unittest.TestCase):
+    def test_split_like(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["test_fun"] = [_test_split_like]
+        arg_dict["shape"] = [(4, 12, 12)]
+        arg_dict["axis"] = [1, 2]
+        arg_dict["sizes"] = [(4, 4, 4), (1, 0, 11)]
+        arg_dict["device"] = ["mlu"]
+        arg_dict["dtype"] = [flow.float32, flow.float16]
+        for arg in GenArgList(arg_dict):
+            arg[0](test_case, *arg[1:])
+
+    def test_split_like_many_outputs(test_case):
+        # more outputs than one launch batch
+        _test_split_like(test_case, (3, 130, 5), 1, [1] * 130, "mlu", flow.float32)
+
+
+if __name__ == "__main__":
+    unittest.main()
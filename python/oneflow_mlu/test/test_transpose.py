@@ -70,6 +70,18 @@ class TestCambriconTranspose(flow.unittest.TestCase):
         for arg in GenArgList(arg_dict):
             arg[0](test_case, *arg[1:])
 
+    def test_transpose_simplified_dims(test_case):
+        for shape, perm in [
+            # only size-1 axes move, this is a plain copy
+            ((3, 1, 4), (1, 0, 2)),
+            # (2 * 3, 4 * 5) with permutation (1, 0)
+            ((2, 3, 4, 5), (2, 3, 0, 1)),
+            ((2, 1, 3, 4), (3, 1, 0, 2)),
+            # 10 axes, 5 of size 1 and the rest reversed
+            ((2, 1, 3, 1, 4, 1, 5, 1, 2, 1), (9, 8, 7, 6, 5, 4, 3, 2, 1, 0)),
+        ]:
+            _test_eager_transpose(test_case, "mlu", shape, perm, flow.float32)
+
 
 if __name__ == "__main__":
     unittest.main()